@@ -0,0 +1,704 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Programma principale: un solo eseguibile con kernel e scambio delle righe di bordo scelti da riga di comando
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#include "gol_engine.h"
+
+int main(int argc, char **argv)
+{
+    int rank,       /* rank processo corrente */
+        num_proc,   /* size communicator */
+        generations, /* numero di generazioni */
+        thread_level;    /* livello di supporto ai thread fornito da MPI */
+
+    long long row_size = 0, /* righe matrice */
+        col_size = 0;       /* colonne matrice */
+    
+    double start_time = 0, end_time; /* per la misurazione dei tempi */
+    
+    int *rows_for_proc, /* memorizza il numero di righe assegnate ad ogni processo */
+        *displ_for_proc;  /* memorizza il displacement per ogni processo */
+    
+    char *game_matrix = NULL; /* matrice di gioco */
+    
+    char *process_buffer,  /* buffer usato dal singolo processore per memorizzare le righe della propria computazione */
+        *result_buffer; /* buffer usato dal singolo processore per memorizzare il risultato della propria computazione */
+    
+    char *file; /* path del file pattern */
+    bool is_file = false, is_test = false; /* indica che la matrice è stata riempita da file */
+    gol_options opt = { /* opzioni da riga di comando */
+        .seed = { SEED_RANDOM, DEF_DENSITY, 0, false, NULL, 0 },
+        .threads = 1,
+        .snapshot_format = SNAPSHOT_PBM,
+        .snapshot_prefix = "snapshot",
+        .snapshot_keyframe = DEF_SNAPSHOT_KEYFRAME,
+        .seek = -1,
+        .viewport_every = 1,
+        .viewport_format = VIEWPORT_ANSI,
+        .progress_rows = DEF_PROGRESS_ROWS,
+        .band_rows = DEF_BAND_ROWS,
+        .rows = DEF_ROWS,
+        .cols = DEF_COLS,
+        .generations = DEF_ITERATION
+    };
+    seed_options *seed = &opt.seed; /* impostazioni di generazione del seed */
+    gen_stats local_stats, *stats = NULL; /* statistiche locali, NULL se disabilitate */
+    stats_reduction reduction = { .pending = false }; /* riduzione delle statistiche fra i processi */
+    FILE *stats_out = NULL; /* file delle statistiche, aperto solo da MASTER */
+    cycle_window window = { 0, NULL, 0 }; /* hash delle ultime generazioni */
+    snapshot_writer snapshots; /* stadio di output asincrono */
+    query_server queries; /* endpoint di interrogazione delle regioni */
+    viewport view; /* mappa di densità mostrata al posto della matrice */
+    grid_arena arena; /* regione che contiene tutti i buffer della porzione */
+    gol_kernel selected = { 0 }; /* kernel scelto, con la sua regola */
+    const gol_kernel *kernel = NULL; /* kernel di calcolo */
+    int radius; /* raggio del vicinato del kernel, righe fantasma per lato */
+    ltl_rule ltl = CONWAY_LTL; /* regola Larger than Life del kernel ltl */
+    gol_kernel reference = { 0 }; /* kernel del riferimento, con la stessa regola */
+    const gol_kernel *verify_kernel = NULL; /* kernel del riferimento per la verifica */
+    verifier check; /* verifica rispetto al motore sequenziale */
+    bool verified = true; /* nessuna differenza trovata dalla verifica */
+    const halo_backend *backend; /* backend di scambio delle righe di bordo */
+    ring_placement place; /* posizione dei processi nell'anello delle righe */
+    halo_exchange halo; /* scambio delle righe di bordo */
+    halo_progress progress; /* avanzamento dello scambio delle righe di bordo */
+    band_stream stream; /* calcolo per bande della porzione su file */
+    unbounded_domain domain; /* finestra del piano illimitato */
+    bool show_matrix; /* la matrice completa viene raccolta e mostrata da MASTER */
+    int cycle = CYCLE_NONE, cycle_gen = 0; /* esito della terminazione anticipata e generazione in cui è avvenuta */
+
+    MPI_Datatype row_data;    /* datatype che indica una riga della matrice */
+
+    /* le opzioni sono lette prima dell'inizializzazione perché il thread di avanzamento richiede MPI_THREAD_MULTIPLE */
+    int parsed = parse_options(argc, argv, &opt);
+
+    /* inizializzazione ambiente MPI */
+    MPI_Init_thread(NULL, NULL, opt.progress == PROGRESS_THREAD || opt.autotune != NULL ? MPI_THREAD_MULTIPLE : MPI_THREAD_SERIALIZED,
+                    &thread_level);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_proc);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    /* una regola Larger than Life sceglie il kernel ltl, gli altri kernel calcolano solo B3/S23 */
+    if (opt.ltl != NULL) {
+        if (!parse_ltl(opt.ltl, &ltl)) {
+            parsed = -1;
+        }
+        if (opt.kernel == NULL) {
+            opt.kernel = "ltl";
+        }
+    }
+    if (bind_kernel(&selected, opt.kernel, &ltl)) {
+        kernel = &selected;
+    }
+    backend = find_halo(opt.halo);
+    if (opt.verify != NULL && bind_kernel(&reference, opt.verify, &ltl)) {
+        verify_kernel = &reference;
+    }
+    /* il riferimento deve usare lo stesso vicinato del kernel verificato */
+    if (kernel != NULL && verify_kernel != NULL && kernel_radius(kernel) != kernel_radius(verify_kernel)) {
+        verify_kernel = NULL;
+    }
+    if (opt.ltl != NULL && kernel != NULL && strcmp(kernel->name, "ltl") != 0) {
+        parsed = -1;
+    }
+    if (parsed < 0 || kernel == NULL || backend == NULL || (opt.verify != NULL && verify_kernel == NULL)) {
+        if (rank == MASTER) {
+            printf("Error, invalid option.\n");
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
+    /* accesso alla storia registrata: MASTER ricostruisce una generazione dai file delta */
+    if (opt.seek >= 0) {
+        if (rank == MASTER) {
+            run_seek(&opt);
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
+    /* motore sequenziale di riferimento: solo MASTER calcola, gli altri processi terminano */
+    if (opt.engine == ENGINE_SEQUENTIAL) {
+        if (rank == MASTER) {
+            run_sequential(&opt, kernel);
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
+    /* modalità ensemble: ogni board è simulata localmente, senza divisione in righe */
+    if (opt.ensemble_file != NULL) {
+        if (opt.threads > 1 && thread_level < MPI_THREAD_SERIALIZED) {
+            if (rank == MASTER) {
+                printf("Warning, MPI_THREAD_SERIALIZED not supported: using 1 thread per process.\n");
+            }
+            opt.threads = 1;
+        }
+        run_ensemble(rank, &opt, opt.threads);
+        MPI_Finalize();
+        return 0;
+    }
+    
+    if (opt.pattern_file != NULL) { /* l'utente ha indicato un pattern da file */
+        is_file = true;
+        if (rank == MASTER) {
+            /* preparazione file */
+            file = pattern_path(opt.pattern_file);
+            printf("--Generate game matrix seed from %s--\n", file);
+            /* il processo master calcola le dimensioni della matrice in base al file */
+            check_matrix_size(file, &row_size, &col_size);
+        }
+        /* MASTER invia la size della matrice a tutti i processi */
+        MPI_Bcast(&row_size, 1, MPI_LONG_LONG, MASTER, MPI_COMM_WORLD);
+        MPI_Bcast(&col_size, 1, MPI_LONG_LONG, MASTER, MPI_COMM_WORLD);
+    } else { /* le dimensioni sono scelte dall'utente o quelle di default */
+        row_size = opt.rows;
+        col_size = opt.cols;
+        is_test = opt.print;
+    }
+    generations = opt.generations;
+
+    /* con la viewport la matrice completa non viene mai raccolta su MASTER */
+    if (opt.viewport_rows > 0) {
+        is_test = false;
+    }
+    /* nel piano illimitato le dimensioni cambiano e la matrice completa non viene raccolta */
+    show_matrix = (is_file || is_test) && opt.viewport_rows == 0 && !opt.unbounded;
+
+    /* 
+    le dimensioni sono a 64 bit, ma i trasferimenti contano righe con int:
+    ogni processo deve avere almeno tante righe quante ne invia ai vicini, pari al raggio
+    del vicinato, e il numero di righe deve stare in un int
+    */
+    radius = kernel_radius(kernel);
+    if (row_size < (long long)num_proc * radius || row_size > INT_MAX || col_size < 1 || col_size > LLONG_MAX / row_size) {
+        if (rank == MASTER) {
+            printf("Error, invalid matrix size %lld x %lld for %d processes.\n", row_size, col_size, num_proc);
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
+    /* crea un nuovo tipo di dato MPI che rappresenta una riga di col_size caratteri */
+    make_row_type(col_size, &row_data);
+
+    /* ogni cella i memorizza il numero di righe assegnate al processo i-esimo */
+    rows_for_proc = calloc(num_proc, sizeof(int));
+    /* ogni cella i memorizza il displacement da applicare al processo i-esimo */
+    displ_for_proc = calloc(num_proc, sizeof(int));
+    
+    /* posizione dei processi nell'anello e divisione delle righe in quell'ordine */
+    placement_open(&place, MPI_COMM_WORLD, opt.topology);
+    split_rows(row_size, num_proc, place.order, rows_for_proc, displ_for_proc);
+
+    /* 
+    ogni processo prepara un'unica arena con la sua porzione di righe e il buffer dei risultati,
+    ognuno allineato ad ARENA_ALIGN byte. Entrambi hanno radius righe fantasma prima e dopo
+    le righe possedute, in cui vengono ricevute le righe di bordo dei processi vicini:
+    i puntatori indicano la prima riga posseduta, le righe fantasma iniziano a -radius * col_size
+    e a rows * col_size
+    */
+    int rows = rows_for_proc[rank];
+    size_t slab_bytes = ((size_t)rows + 2 * radius) * col_size;
+    /* fuori memoria l'arena è un file mappato, di cui restano in memoria solo le bande in uso */
+    if (opt.out_of_core != NULL) {
+        if (!arena_open_file(&arena, 2 * (slab_bytes + ARENA_ALIGN), opt.out_of_core)) {
+            fprintf(stderr, "Error, cannot map %zu bytes in %s on rank %d.\n", 2 * slab_bytes, opt.out_of_core, rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    } else if (!arena_open(&arena, 2 * (slab_bytes + ARENA_ALIGN), opt.huge_pages)) {
+        fprintf(stderr, "Error, cannot map %zu bytes on rank %d.\n", 2 * slab_bytes, rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    /* 
+    il backend di scambio prepara i due buffer di generazione: shm li alloca in memoria condivisa,
+    se non tutti i processi sono sullo stesso nodo si usa ring
+    */
+    if (!halo_open(&halo, backend, &arena, row_data, rank, num_proc, &place, rows_for_proc, col_size, radius)) {
+        if (rank == MASTER) {
+            printf("Warning, halo %s not available: using ring.\n", backend->name);
+        }
+        backend = find_halo("ring");
+        halo_open(&halo, backend, &arena, row_data, rank, num_proc, &place, rows_for_proc, col_size, radius);
+    }
+    process_buffer = halo.buffers[0];
+    result_buffer = halo.buffers[1];
+    if (opt.out_of_core != NULL) {
+        stream_open(&stream, &arena, opt.band_rows, rows, col_size, radius);
+    }
+    if (rank == MASTER && opt.huge_pages) {
+        static const char *pages[] = { "small", "hugetlb", "thp" };
+        printf("Arena: %zu MB per process, %s pages, NUMA node %d\n", arena.size >> 20, pages[arena.pages], arena.numa_node);
+    }
+    
+    if(rank == MASTER) {    
+        /* nel caso di file presente, solo master inizializza la matrice */
+        start_time = MPI_Wtime();
+        if(is_file) {
+            /* viene allocata la matrice di gioco */ 
+            game_matrix = checked_alloc(row_size, col_size);
+            /* inizializzata da file */
+            init_from_file(game_matrix, row_size, col_size, file);
+        }
+        if(is_test) {
+            /* viene allocata la matrice di gioco per mostrare i risultati delle varie operazioni */ 
+            game_matrix = checked_alloc(row_size, col_size);
+            init_test_matrix(game_matrix, row_size, col_size);
+        }
+        printf("Settings: generations %d \trows %lld \tcolumns %lld \tkernel %s \thalo %s\n",
+               generations, row_size, col_size, kernel->name, backend->name);
+        if (opt.topology) {
+            printf("Topology: %d nodes, %d sockets, ring edges crossing nodes %d -> %d, crossing sockets %d -> %d\n",
+                   place.nodes, place.sockets, place.cross_node[0], place.cross_node[1],
+                   place.cross_socket[0], place.cross_socket[1]);
+        }
+    }
+
+    /* 
+    se non è presente file, ogni processo genera localmente la sua porzione:
+    il seme comune viene scelto da MASTER se l'utente non lo ha indicato
+    */
+    if(!is_file) {
+        if (!seed->has_seed) {
+            seed->seed = (uint64_t)time(NULL);
+            MPI_Bcast(&seed->seed, 1, MPI_UINT64_T, MASTER, MPI_COMM_WORLD);
+        }
+        bool seeded = opt.out_of_core != NULL ? stream_seed(&stream, seed, process_buffer, displ_for_proc[rank], row_size)
+                      : seed_slab(seed, process_buffer, displ_for_proc[rank], rows_for_proc[rank], row_size, col_size);
+        if (!seeded) {
+            if (rank == MASTER) {
+                printf("Error, pattern %s not found.\n", seed->pattern);
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    /* la matrice inizializzata da file viene divisa ed inviata, per righe, agli altri processi */
+    if(is_file) {
+        MPI_Scatterv(game_matrix, rows_for_proc, displ_for_proc, row_data, process_buffer, rows_for_proc[rank], row_data, MASTER, MPI_COMM_WORLD);
+    }
+
+    /* 
+    autotuning: kernel, scambio e avanzamento vengono scelti con prove brevi sulla porzione iniziale,
+    oppure letti dal file di tuning se la stessa macchina ha già risolto lo stesso problema.
+    Se cambia il backend, i buffer vengono ripresi dall'inizio dell'arena con la porzione iniziale
+    */
+    if (opt.autotune != NULL) {
+        tune_choice choice;
+        autotune(&choice, &opt, &ltl, &halo, rows_for_proc, row_size, process_buffer, thread_level);
+        const halo_backend *tuned = find_halo(choice.halo);
+        unbind_kernel(&selected);
+        if (tuned == NULL || !bind_kernel(&selected, choice.kernel, &ltl)) {
+            fprintf(stderr, "Error, tuned kernel %s or halo %s not available on rank %d.\n", choice.kernel, choice.halo, rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        opt.progress = choice.progress;
+        opt.progress_rows = choice.progress_rows;
+        if (tuned != backend) {
+            char *initial = checked_alloc(rows, col_size);
+            memcpy(initial, process_buffer, (size_t)rows * col_size);
+            halo_close(&halo);
+            arena.used = 0;
+            backend = tuned;
+            if (!halo_open(&halo, backend, &arena, row_data, rank, num_proc, &place, rows_for_proc, col_size, radius)) {
+                fprintf(stderr, "Error, cannot open halo %s on rank %d.\n", backend->name, rank);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            process_buffer = halo.buffers[0];
+            result_buffer = halo.buffers[1];
+            memcpy(process_buffer, initial, (size_t)rows * col_size);
+            free(initial);
+        }
+        if (rank == MASTER) {
+            static const char *modes[] = { "none", "test", "thread" };
+            printf("Autotune: kernel %s, halo %s, progress %s every %d rows, %f s per generation (%s)\n",
+                   kernel->name, backend->name, modes[opt.progress], opt.progress_rows, choice.seconds,
+                   choice.trials > 0 ? "measured" : "from tuning file");
+        }
+    }
+
+    /* 
+    raccoglie i dati da tutti i processi del communicator e li concatena nel buffer del processo master 
+    MPI_Gatherv consente ai messaggi ricevuti di avere lunghezze diverse e di essere memorizzati
+    in posizioni arbitrarie nel buffer del processo MASTER. 
+    
+    Utilizzata solo nella fase di test per stampare la matrice a video
+    */
+    
+    if(is_test) {
+        MPI_Gatherv(process_buffer, rows_for_proc[rank], row_data, game_matrix, rows_for_proc, displ_for_proc, row_data, MASTER, MPI_COMM_WORLD); 
+    }
+
+        
+    /* in caso di test o di file, il processo MASTER mostra su stdout la matrice di partenza */
+    if(rank == MASTER) {
+        if(show_matrix) {
+            print_matrix(0, game_matrix, row_size, col_size);
+        }
+    }
+
+    /* con la viewport viene mostrata solo la mappa di densità */
+    if (opt.viewport_rows > 0) {
+        if (!viewport_open(&view, &opt, rank, num_proc, row_size, col_size, rows_for_proc, displ_for_proc)) {
+            printf("Error, cannot open viewport output %s.\n", opt.viewport_out);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        viewport_frame(&view, rank, 0, process_buffer, rows_for_proc[rank], displ_for_proc[rank]);
+    }
+
+    char *temp; /* per lo scambio di puntatori */
+
+    /* 
+    le righe fantasma della generazione iniziale vengono scambiate prima del ciclo,
+    da qui in poi ogni generazione riceve le sue durante il calcolo della precedente
+    */
+    backend->start(&halo, process_buffer);
+    backend->finish(&halo);
+
+    /* senza sovrapposizione fra scambio e calcolo non c'è nulla da far avanzare */
+    if (!backend->overlap) {
+        opt.progress = PROGRESS_NONE;
+    }
+    /* senza MPI_THREAD_MULTIPLE il thread non può chiamare MPI insieme al thread principale */
+    if (opt.progress == PROGRESS_THREAD && thread_level < MPI_THREAD_MULTIPLE) {
+        if (rank == MASTER) {
+            printf("Warning, MPI_THREAD_MULTIPLE not supported: using --progress=test.\n");
+        }
+        opt.progress = PROGRESS_TEST;
+    }
+    progress_open(&progress, &halo, opt.progress, opt.progress_rows);
+
+    /* statistiche per generazione, necessarie anche alla terminazione anticipata: solo MASTER scrive il file */
+    if (opt.stop_period > 0) {
+        stats = &local_stats;
+        window.period = opt.stop_period;
+        window.hashes = calloc(opt.stop_period + 1, sizeof(uint64_t));
+    }
+    /* il piano illimitato segue il bounding box ridotto ad ogni generazione */
+    if (opt.unbounded) {
+        stats = &local_stats;
+    }
+    /* la verifica confronta celle vive e hash ridotti ad ogni generazione */
+    if (opt.verify != NULL) {
+        stats = &local_stats;
+        verify_open(&check, verify_kernel, rank, process_buffer, row_size, col_size, rows_for_proc, displ_for_proc, row_data);
+    }
+    if (opt.stats_file != NULL) {
+        stats = &local_stats;
+        if (rank == MASTER) {
+            stats_out = fopen(opt.stats_file, "w");
+            if (stats_out == NULL) {
+                printf("Error, cannot open %s.\n", opt.stats_file);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            fprintf(stats_out, "# generation live births deaths min_row min_col max_row max_col\n");
+        }
+    }
+    if (stats != NULL) {
+        /* la generazione iniziale viene ridotta durante il calcolo della prima */
+        slab_stats(process_buffer, rows_for_proc[rank], col_size, displ_for_proc[rank], stats);
+        /* la finestra iniziale viene adattata alle celle vive prima della prima generazione */
+        if (opt.unbounded) {
+            unsigned long long live;
+            long long bounds[4];
+            unbounded_open(&domain, row_size, col_size, radius);
+            unbounded_bounds(stats, &live, bounds);
+            if (unbounded_fit(&domain, live, bounds, num_proc)) {
+                unbounded_resize(&domain, &halo, &arena, opt.huge_pages, &row_data, rank, num_proc,
+                                 rows_for_proc, displ_for_proc, process_buffer, NULL);
+                process_buffer = halo.buffers[0];
+                result_buffer = halo.buffers[1];
+                row_size = domain.rows;
+                col_size = domain.cols;
+                rows = rows_for_proc[rank];
+                slab_stats(process_buffer, rows, col_size, displ_for_proc[rank], stats);
+                reduction.origin[0] = domain.origin_row;
+                reduction.origin[1] = domain.origin_col;
+            }
+        }
+        start_stats(&reduction, stats, 0);
+    }
+
+    /* stadio di output asincrono: ogni processo salva la propria porzione */
+    if (opt.snapshot_every > 0) {
+        if (!snapshot_open(&snapshots, &opt, rank, num_proc, rows_for_proc[rank], col_size, displ_for_proc[rank], row_size)) {
+            printf("Error, cannot open snapshot output %s.\n", opt.snapshot_prefix);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        snapshot_push(&snapshots, 0, process_buffer);
+    }
+
+    /* endpoint di interrogazione: MASTER ascolta sul socket, le regioni vengono raccolte fra due generazioni */
+    if (opt.query != NULL) {
+        if (!query_open(&queries, opt.query, rank, num_proc, row_size, col_size, rows_for_proc, displ_for_proc)) {
+            if (rank == MASTER) {
+                printf("Error, cannot open query socket %s.\n", opt.query);
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    /* 
+    fuori memoria le righe interne vengono calcolate per bande: la porzione iniziale, letta
+    anche da statistiche e output, viene portata sul file e rilasciata prima della prima generazione
+    */
+    if (opt.out_of_core != NULL) {
+        stream_release(&stream, process_buffer);
+        progress.stream = &stream;
+    }
+
+    for(int gen = 0; gen < generations; gen++) {
+        if (stats != NULL) {
+            reset_stats(stats);
+        }
+        
+        /* scambia i puntatori */
+        if(gen > 0) {
+            if( gen%2 == 0) {
+                temp = result_buffer;
+                result_buffer = process_buffer;
+                process_buffer = temp;
+            } else {
+                temp = process_buffer;
+                process_buffer = result_buffer;
+                result_buffer = temp;
+            }
+        }
+        
+            
+        /* 
+        le righe di bordo della nuova generazione, le prime e le ultime radius, dipendono solo
+        dalla porzione corrente e dalle sue righe fantasma, già ricevute: vengono calcolate per prime
+        (una sola volta se il processo possiede meno di 2 * radius righe)
+        */
+        compute_rows(kernel, process_buffer, result_buffer, 0, radius, col_size, displ_for_proc[rank], stats);
+        if (rows > radius) {
+            compute_rows(kernel, process_buffer, result_buffer, rows - radius > radius ? rows - radius : radius, rows,
+                         col_size, displ_for_proc[rank], stats);
+        }
+
+        /* 
+        le righe di bordo vengono subito inviate ai vicini e le loro ricevute nelle righe fantasma
+        del buffer dei risultati, così restano in transito per tutto il calcolo delle righe interne
+        */
+        backend->start(&halo, result_buffer);
+
+        /* calcola le righe interne, che non necessitano di aiuto da altri processi */
+        progress_compute(&progress, &halo, kernel, process_buffer, result_buffer, displ_for_proc[rank], stats);
+
+        /* 
+        la nuova generazione è completa solo con le righe fantasma ricevute, e le righe di bordo
+        non possono essere sovrascritte due generazioni dopo finché gli invii non sono terminati
+        */
+        progress_wait(&progress, &halo);
+
+        /* 
+        le statistiche della generazione precedente vengono completate e scritte,
+        quelle appena calcolate vengono ridotte mentre si calcola la generazione successiva
+        */
+        if (stats != NULL) {
+            finish_stats(&reduction, stats_out);
+            /* alla prima differenza tutti i processi terminano insieme */
+            if (opt.verify != NULL) {
+                verified = verify_generation(&check, rank, reduction.gen, reduction.counters_out[0], reduction.counters_out[3],
+                                             process_buffer, rows_for_proc, displ_for_proc, row_data);
+                if (!verified) {
+                    break;
+                }
+            }
+            if (opt.stop_period > 0) {
+                /* lo stato globale della generazione ridotta viene confrontato con quelli precedenti */
+                cycle = check_cycle(&window, reduction.counters_out[0], reduction.counters_out[3]);
+                cycle_gen = reduction.gen;
+            }
+            /* 
+            nel piano illimitato la finestra segue il bounding box della generazione ridotta:
+            la generazione appena calcolata viene spostata prima di avviarne la riduzione
+            */
+            if (opt.unbounded) {
+                long long bounds[4] = { reduction.bounds_out[0], reduction.bounds_out[1], -reduction.bounds_out[2], -reduction.bounds_out[3] };
+                if (unbounded_fit(&domain, reduction.counters_out[0], bounds, num_proc)) {
+                    unbounded_resize(&domain, &halo, &arena, opt.huge_pages, &row_data, rank, num_proc,
+                                     rows_for_proc, displ_for_proc, result_buffer, stats);
+                    result_buffer = halo.buffers[0];
+                    process_buffer = halo.buffers[1];
+                    row_size = domain.rows;
+                    col_size = domain.cols;
+                    rows = rows_for_proc[rank];
+                    reduction.origin[0] = domain.origin_row;
+                    reduction.origin[1] = domain.origin_col;
+                    /* gli hash usano le coordinate della finestra: quelli della finestra precedente non sono confrontabili */
+                    window.seen = 0;
+                }
+            }
+            start_stats(&reduction, stats, gen + 1);
+        }
+
+        /* la copia della porzione viene accodata, la scrittura avviene sul thread di output */
+        if (opt.snapshot_every > 0 && (gen + 1) % opt.snapshot_every == 0) {
+            snapshot_push(&snapshots, gen + 1, result_buffer);
+        }
+
+        /* le richieste accodate dal thread dell'endpoint avanzano di un passo ad ogni generazione */
+        if (opt.query != NULL) {
+            query_step(&queries, gen + 1, result_buffer);
+        }
+
+        /* 
+            le righe appena calcolate vengono reinviate al master e memorizzate in game_matrix
+            nel caso di test e file per permettere di mostrare la matrice a video
+        */
+        if (show_matrix)
+            MPI_Gatherv(result_buffer, rows_for_proc[rank], row_data, game_matrix, rows_for_proc, displ_for_proc, row_data, MASTER, MPI_COMM_WORLD);
+
+        /* nel caso di file o di test viene mostrata la matrice dopo ogni iterazione */
+        if(rank == MASTER) {
+            if(show_matrix) {
+                print_matrix(gen + 1, game_matrix, row_size, col_size);
+            }
+        }
+
+        /* la viewport muove solo la mappa ridotta */
+        if (opt.viewport_rows > 0 && (gen + 1) % opt.viewport_every == 0) {
+            viewport_frame(&view, rank, gen + 1, result_buffer, rows_for_proc[rank], displ_for_proc[rank]);
+        }
+
+        /* tutti i processi hanno ricevuto la stessa riduzione e terminano insieme */
+        if (cycle != CYCLE_NONE) {
+            break;
+        }
+    }
+    
+    /* 
+    riporta il tempo di calcolo delle righe interne e quello di attesa delle righe di bordo:
+    se le comunicazioni avanzano durante il calcolo, l'attesa resta vicina a zero
+    */
+    progress_close(&progress);
+    if (opt.progress_report) {
+        static const char *modes[] = { "none", "test", "thread" };
+        double times[2] = { progress.compute_time, progress.wait_time }, max_times[2];
+        long polls;
+        MPI_Reduce(times, max_times, 2, MPI_DOUBLE, MPI_MAX, MASTER, MPI_COMM_WORLD);
+        MPI_Reduce(&progress.polls, &polls, 1, MPI_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+        if (rank == MASTER) {
+            printf("Halo progress %s: max interior compute %f s, max halo wait %f s, %ld progress calls\n",
+                   modes[progress.mode], max_times[0], max_times[1], polls);
+        }
+    }
+
+    /* fuori memoria si riporta il volume scritto sul file e l'attesa delle scritture */
+    if (opt.out_of_core != NULL) {
+        double times[2] = { progress.compute_time, stream.wait_time }, max_times[2];
+        long long written;
+        MPI_Reduce(times, max_times, 2, MPI_DOUBLE, MPI_MAX, MASTER, MPI_COMM_WORLD);
+        MPI_Reduce(&stream.written, &written, 1, MPI_LONG_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+        if (rank == MASTER) {
+            printf("Out-of-core: %zu MB file per process in %s, bands of %d rows, %lld MB written at %.1f MB/s, "
+                   "max writeback wait %f s\n", arena.size >> 20, opt.out_of_core, opt.band_rows, written >> 20,
+                   max_times[0] > 0 ? (written >> 20) / max_times[0] : 0.0, max_times[1]);
+        }
+    }
+
+    /* il backend compact riporta i byte delle righe di bordo risparmiati dalla codifica */
+    if (strcmp(halo.backend->name, "compact") == 0) {
+        long long counters[3] = { halo.sent_bytes, halo.messages[HALO_SPARSE], halo.messages[HALO_DENSE] }, totals[3];
+        MPI_Reduce(counters, totals, 3, MPI_LONG_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+        if (rank == MASTER) {
+            printf("Halo compact: %lld bytes sent instead of %lld, %lld sparse and %lld dense rows\n",
+                   totals[0], (totals[1] + totals[2]) * col_size, totals[1], totals[2]);
+        }
+    }
+
+    /* completa l'ultima riduzione delle statistiche, l'ultima generazione è nel buffer dei risultati */
+    bool last_pending = reduction.pending;
+    finish_stats(&reduction, stats_out);
+    if (opt.verify != NULL) {
+        if (verified && last_pending) {
+            verify_generation(&check, rank, reduction.gen, reduction.counters_out[0], reduction.counters_out[3],
+                              reduction.gen == 0 ? process_buffer : result_buffer, rows_for_proc, displ_for_proc, row_data);
+        }
+        verified = verify_close(&check, rank);
+    }
+    if (stats_out != NULL) {
+        fclose(stats_out);
+    }
+    free(window.hashes);
+
+    if (opt.viewport_rows > 0) {
+        viewport_close(&view);
+    }
+
+    /* attende la scrittura degli ultimi snapshot e riporta il tempo perso dal calcolo */
+    if (opt.snapshot_every > 0) {
+        double max_stall;
+        long errors;
+        snapshot_close(&snapshots);
+        MPI_Reduce(&snapshots.stall_time, &max_stall, 1, MPI_DOUBLE, MPI_MAX, MASTER, MPI_COMM_WORLD);
+        MPI_Reduce(&snapshots.errors, &errors, 1, MPI_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+        if (rank == MASTER) {
+            printf("Snapshots: %ld written, %ld write errors, max stall %f s\n", snapshots.written, errors, max_stall);
+        }
+        /* il formato delta riporta i byte scritti rispetto alle righe compresse */
+        if (opt.snapshot_format == SNAPSHOT_DELTA) {
+            long long bytes[2] = { snapshots.encoded_bytes, snapshots.raw_bytes }, totals[2];
+            MPI_Reduce(bytes, totals, 2, MPI_LONG_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+            if (rank == MASTER) {
+                printf("Snapshot deltas: %lld bytes written instead of %lld, keyframe every %d snapshots\n",
+                       totals[0], totals[1], opt.snapshot_keyframe);
+            }
+        }
+    }
+
+    /* completa l'ultima raccolta e chiude il socket */
+    if (opt.query != NULL) {
+        query_close(&queries);
+        if (rank == MASTER) {
+            printf("Query: %ld rectangles served, %ld requests rejected\n", queries.served, queries.rejected);
+        }
+    }
+
+    /* MASTER riporta il motivo della terminazione anticipata */
+    if (rank == MASTER && cycle != CYCLE_NONE) {
+        if (cycle == CYCLE_EXTINCTION) {
+            printf("Early stop: extinction at generation %d\n", cycle_gen);
+        } else if (cycle == 1) {
+            printf("Early stop: still life at generation %d\n", cycle_gen);
+        } else {
+            printf("Early stop: period %d oscillation at generation %d\n", cycle, cycle_gen);
+        }
+    }
+
+    /* MASTER riporta la posizione finale della finestra del piano illimitato */
+    if (rank == MASTER && opt.unbounded) {
+        printf("Unbounded: window %lld x %lld at row %lld column %lld, %d resizes, largest window %lld cells\n",
+               domain.rows, domain.cols, domain.origin_row, domain.origin_col, domain.resizes, domain.max_cells);
+    }
+
+    /* sincronizza tutti i processi affinchè arrivino tutti al medesimo punto */
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    /* libera la memoria dinamica allocata */
+    halo_close(&halo);
+    arena_close(&arena);
+    placement_close(&place);
+    unbind_kernel(&selected);
+    unbind_kernel(&reference);
+
+    /* il processo master mostra il tempo di esecuzione */
+    if(rank == MASTER) {
+        if(is_file || is_test){
+          free(game_matrix);  
+        }
+        end_time = MPI_Wtime();
+        printf("\nExecution Time: %f ms\n", end_time - start_time);
+    }
+    MPI_Finalize();
+    return verified ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Interfaccia della libreria: il motore parallelo usato da un altro programma, senza processi né file intermedi
+ * Francesco Pio Covino
+ */
+#ifndef GOL_H
+#define GOL_H
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* valori di una cella, gli stessi dei pattern in patterns/ */
+#define GOL_ALIVE 'O'
+#define GOL_DEAD '.'
+
+/* simulazione di una matrice divisa per righe fra i processi di un communicator */
+typedef struct gol_sim gol_sim;
+
+/* porzione posseduta dal processo, nel buffer della generazione corrente */
+typedef struct {
+    char *cells;            /* prima cella della prima riga posseduta */
+    long long first_row;    /* indice globale della prima riga posseduta */
+    int rows;               /* righe possedute */
+    long long cols;         /* colonne della matrice */
+    long long stride;       /* celle fra l'inizio di due righe consecutive */
+    long long generation;   /* generazione contenuta nella porzione */
+} gol_slab;
+
+gol_sim *gol_create(MPI_Comm comm, long long rows, long long cols, const char *rule);
+void gol_step(gol_sim *sim, int generations);
+gol_slab gol_view_local_slab(gol_sim *sim);
+int gol_set_region(gol_sim *sim, long long row, long long col, long long rows, long long cols,
+                   const char *cells, long long stride);
+void gol_destroy(gol_sim *sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
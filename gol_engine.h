@@ -0,0 +1,674 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Definizioni comuni ai moduli del motore
+ * Francesco Pio Covino
+ */
+#ifndef GOL_ENGINE_H
+#define GOL_ENGINE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <mpi.h>
+
+/* rank processo master */
+#define MASTER 0
+
+/* stati possibili per una cella */
+#define ALIVE 'O'
+#define DEAD '.'
+
+/* tag per identificare invio e ricezione */
+#define TAG_NEXT 14
+#define TAG_PREV 41
+
+/* dimensioni di default della matrice, se non specificate */
+#define DEF_ROWS 240
+#define DEF_COLS 360
+#define DEF_ITERATION 10
+
+/* densità di default del seed casuale, equivalente al vecchio rand() % 2 */
+#define DEF_DENSITY 0.5
+
+/* modalità di generazione del seed */
+#define SEED_RANDOM 0  /* ogni cella è viva con probabilità pari alla densità */
+#define SEED_TILE 1    /* il pattern viene ripetuto su tutta la matrice */
+#define SEED_SCATTER 2 /* copie del pattern in posizioni casuali */
+
+/* impostazioni per la generazione del seed */
+typedef struct {
+    int mode;          /* una delle modalità SEED_* */
+    double density;    /* probabilità che una cella sia viva (SEED_RANDOM) */
+    uint64_t seed;     /* seme comune a tutti i processi */
+    bool has_seed;     /* indica che il seme è stato scelto dall'utente */
+    char *pattern;     /* nome del pattern (SEED_TILE e SEED_SCATTER) */
+    long copies;       /* numero di copie del pattern (SEED_SCATTER) */
+} seed_options;
+
+/* regola di evoluzione in notazione B/S: il bit k indica che k vicini vivi fanno nascere o sopravvivere la cella */
+typedef struct {
+    uint16_t birth;
+    uint16_t survive;
+} life_rule;
+
+/* regola classica di Conway, B3/S23 */
+#define CONWAY_RULE { 1 << 3, (1 << 2) | (1 << 3) }
+
+/* motori di calcolo */
+#define ENGINE_PARALLEL 0   /* matrice divisa per righe fra i processi MPI */
+#define ENGINE_SEQUENTIAL 1 /* intera matrice su un solo core, riferimento per lo speedup */
+
+/* formati degli snapshot */
+#define SNAPSHOT_PBM 0 /* un file PBM binario per generazione, scritto in parallelo */
+#define SNAPSHOT_RLE 1 /* un file RLE per processo, con un blocco per generazione */
+#define SNAPSHOT_DELTA 2 /* un file per processo: keyframe periodici e XOR delle righe compresse fra uno snapshot e il successivo */
+
+/* record di un file delta, primo byte di ogni snapshot */
+#define DELTA_KEYFRAME 'K' /* XOR rispetto a una porzione vuota */
+#define DELTA_XOR 'D'      /* XOR rispetto allo snapshot precedente */
+/* intestazione dei file delta */
+#define DELTA_MAGIC "GOLDELTA"
+
+/* voce dell'indice di un file delta: generazione e posizione del suo record, nell'ordine dei record */
+typedef struct {
+    long long gen;
+    long long offset;
+} delta_entry;
+
+/* slot dello stadio di output: snapshot che possono attendere la scrittura */
+#define DEF_SNAPSHOT_SLOTS 4
+/* snapshot fra due keyframe del formato delta */
+#define DEF_SNAPSHOT_KEYFRAME 64
+
+/* interrogazioni di regioni su socket Unix */
+#define QUERY_BATCH 16              /* rettangoli raccolti in un unico giro fra i processi */
+#define QUERY_QUEUE 64              /* richieste accettate in attesa di risposta */
+#define QUERY_MAX_CELLS (1 << 24)   /* celle di un giro di raccolta, e quindi di un rettangolo */
+
+/* modalità di avanzamento delle comunicazioni delle righe di bordo */
+#define PROGRESS_NONE 0     /* le comunicazioni avanzano solo in MPI_Waitall */
+#define PROGRESS_TEST 1     /* avanzamento esplicito ogni progress_rows righe interne */
+#define PROGRESS_THREAD 2   /* thread dedicato che chiama MPI_Iprobe durante il calcolo */
+
+/* codifica di una riga di bordo nel backend compact, primo byte del messaggio */
+#define HALO_SPARSE 0   /* numero di celle vive e lunghezze delle sequenze di celle morte fra esse, in varint */
+#define HALO_DENSE 1    /* un bit per cella */
+
+/* righe interne calcolate fra due chiamate di avanzamento */
+#define DEF_PROGRESS_ROWS 16
+
+/* generazioni misurate in ogni prova dell'autotuning, dopo una di riscaldamento */
+#define TUNE_GENERATIONS 4
+
+/* configurazione scelta dall'autotuning */
+typedef struct {
+    char kernel[16];        /* nome del kernel di calcolo */
+    char halo[16];          /* nome del backend di scambio delle righe di bordo */
+    int progress;           /* una delle modalità PROGRESS_* */
+    int progress_rows;      /* righe interne fra due chiamate di avanzamento */
+    double seconds;         /* tempo per generazione del processo più lento */
+    int trials;             /* prove eseguite, 0 se letta dal file di tuning */
+} tune_choice;
+
+/* allineamento dei buffer nell'arena: una linea di cache, sufficiente per AVX-512 */
+#define ARENA_ALIGN 64
+/* dimensione di una huge page, a cui viene arrotondata l'arena */
+#define ARENA_HUGE_PAGE (2UL << 20)
+/* politica NUMA MPOL_PREFERRED di mbind, definita qui per non dipendere da libnuma */
+#define ARENA_MPOL_PREFERRED 1
+
+/* tipo di pagine dell'arena */
+#define ARENA_SMALL 0   /* pagine normali */
+#define ARENA_HUGETLB 1 /* huge page riservate (MAP_HUGETLB) */
+#define ARENA_THP 2     /* transparent huge page (MADV_HUGEPAGE) */
+#define ARENA_FILE 3    /* file mappato in memoria (--out-of-core) */
+
+/* righe interne di una banda fuori memoria */
+#define DEF_BAND_ROWS 64
+
+/* arena di un processo: un'unica regione mappata per i buffer della matrice */
+typedef struct {
+    char *base;         /* inizio della regione */
+    size_t size;        /* byte mappati */
+    size_t used;        /* byte già assegnati ai buffer */
+    int pages;          /* uno dei tipi ARENA_* */
+    int numa_node;      /* nodo NUMA preferito, -1 se non impostato */
+    int fd;             /* file che contiene la regione, -1 se anonima */
+} grid_arena;
+
+/* 
+calcolo fuori memoria: le righe interne vengono calcolate per bande, la lettura anticipata
+della banda successiva e la scrittura della banda appena calcolata avanzano nel kernel
+durante il calcolo, e le bande già scritte vengono rilasciate
+*/
+typedef struct {
+    const grid_arena *arena; /* arena mappata sul file */
+    int band_rows;          /* righe interne di una banda */
+    int rows;               /* righe possedute */
+    long long cols;         /* colonne della matrice */
+    int depth;              /* righe fantasma per lato */
+    char *origin, *result;  /* buffer della generazione in corso */
+    int band;               /* prima riga della banda in corso */
+    int end;                /* fine delle righe interne */
+    int pending_lo, pending_hi; /* banda dei risultati in scrittura, vuota se pending_lo == pending_hi */
+    int released;           /* righe del buffer di partenza già rilasciate */
+    long long written;      /* byte dei risultati scritti sul file */
+    double wait_time;       /* attesa del completamento delle scritture */
+} band_stream;
+
+/* formati dei frame della viewport */
+#define VIEWPORT_ANSI 0 /* caratteri di densità su terminale */
+#define VIEWPORT_PGM 1  /* immagini PGM binarie accodate */
+
+/* numero di valori per board nei risultati della modalità ensemble */
+#define ENSEMBLE_FIELDS 4
+/* board simulate insieme dal motore bit-sliced, una per bit di una parola */
+#define ENSEMBLE_LANES 64
+/* board trasferite da una singola collettiva della modalità ensemble, i conteggi MPI sono int */
+#define ENSEMBLE_CHUNK (1L << 20)
+
+/* una board della modalità ensemble, simulata interamente da un solo thread */
+typedef struct {
+    int rows, cols;     /* dimensioni della board */
+    int generations;    /* generazioni da calcolare */
+    double density;     /* densità del seed casuale */
+    uint64_t seed;      /* seme del seed casuale */
+    life_rule rule;     /* regola di evoluzione */
+} ensemble_job;
+
+/* opzioni passate da riga di comando nella forma --nome=valore */
+typedef struct {
+    long long rows, cols;   /* dimensioni della matrice */
+    int generations;        /* numero di generazioni */
+    char *pattern_file;     /* pattern da cui leggere la matrice, NULL per generarla */
+    bool print;             /* la matrice viene mostrata dopo ogni generazione */
+    char *kernel;           /* nome del kernel di calcolo */
+    char *halo;             /* nome del backend di scambio delle righe di bordo */
+    int engine;             /* uno dei motori ENGINE_* */
+    char *verify;           /* kernel del riferimento con cui verificare ogni generazione, NULL se disabilitata */
+    seed_options seed;  /* generazione del seed */
+    char *stats_file;   /* file in cui scrivere le statistiche per generazione, NULL se disabilitate */
+    int stop_period;    /* periodo massimo delle oscillazioni che terminano l'esecuzione, 0 se disabilitato */
+    char *ensemble_file;    /* lista di board della modalità ensemble, NULL se disabilitata */
+    char *ensemble_out;     /* file dei risultati della modalità ensemble, NULL per stdout */
+    int threads;            /* thread per processo nella modalità ensemble */
+    bool ensemble_sliced;   /* modalità ensemble con il motore bit-sliced */
+    int snapshot_every;     /* generazioni fra due snapshot, 0 se disabilitati */
+    int snapshot_format;    /* uno dei formati SNAPSHOT_* */
+    char *snapshot_prefix;  /* prefisso dei file di snapshot */
+    int snapshot_keyframe;  /* snapshot fra due keyframe del formato delta */
+    int seek;               /* generazione da ricostruire dai file delta, -1 se disabilitato */
+    int viewport_rows, viewport_cols; /* risoluzione della viewport, 0 se disabilitata */
+    int viewport_every;     /* generazioni fra due frame della viewport */
+    int viewport_format;    /* uno dei formati VIEWPORT_* */
+    char *viewport_out;     /* file dei frame, NULL per stdout */
+    bool huge_pages;        /* arena su huge page */
+    int progress;           /* una delle modalità PROGRESS_* */
+    int progress_rows;      /* righe interne fra due chiamate di avanzamento */
+    bool progress_report;   /* riporta i tempi di calcolo e di attesa delle righe di bordo */
+    bool unbounded;         /* piano illimitato invece del toroide */
+    char *ltl;              /* regola Larger than Life del kernel ltl, NULL per B3/S23 */
+    bool topology;          /* posizione nell'anello secondo nodi e socket invece del rank */
+    char *query;            /* socket Unix dell'endpoint di interrogazione, NULL se disabilitato */
+    char *out_of_core;      /* cartella del file che contiene la porzione, NULL se in memoria */
+    int band_rows;          /* righe interne di una banda fuori memoria */
+    char *autotune;         /* file di tuning delle configurazioni già scelte, NULL se disabilitato */
+} gol_options;
+
+/* viewport: mappa di densità a bassa risoluzione dell'intera matrice */
+typedef struct {
+    int format;             /* uno dei formati VIEWPORT_* */
+    int rows, cols;         /* risoluzione della mappa */
+    long long row_size, col_size; /* dimensioni della matrice */
+    int procs;              /* numero di processi */
+    int *col_map;           /* colonna ridotta di ogni colonna della matrice */
+    int local_lo;           /* prima riga ridotta toccata dal processo */
+    int local_count;        /* righe ridotte toccate dal processo */
+    long long *local;       /* celle vive per cella ridotta, sulle righe del processo */
+    int *recv_counts, *recv_displs, *block_lo; /* layout della Gatherv, solo MASTER */
+    long long *gathered;    /* blocchi ricevuti dai processi, solo MASTER */
+    long long *map;         /* celle vive per cella ridotta, solo MASTER */
+    long long *row_area, *col_area; /* righe e colonne della matrice per riga e colonna ridotta, solo MASTER */
+    FILE *out;              /* file dei frame, solo MASTER */
+} viewport;
+
+/* stadio di output asincrono: coda circolare di copie della porzione svuotata da un thread dedicato */
+typedef struct {
+    int format;             /* uno dei formati SNAPSHOT_* */
+    char *prefix;           /* prefisso dei file */
+    int rank;               /* rank del processo */
+    int rows;               /* righe della porzione */
+    long long cols;         /* colonne della matrice */
+    long long first_row;    /* indice globale della prima riga della porzione */
+    long long row_size;     /* righe della matrice globale */
+    char **slots;           /* copie della porzione in attesa di scrittura */
+    int *gens;              /* generazione di ogni slot */
+    int slot_count;         /* numero di slot */
+    int head, count;        /* primo slot occupato e numero di slot occupati */
+    bool closing;           /* richiesta di terminazione al thread */
+    unsigned char *packed;  /* buffer per la codifica PBM e delta */
+    unsigned char *previous; /* righe compresse dello snapshot precedente (delta) */
+    unsigned char *encoded; /* record in costruzione (delta) */
+    int keyframe_every;     /* snapshot fra due keyframe (delta) */
+    long long raw_bytes;    /* byte delle righe compresse degli snapshot (delta) */
+    long long encoded_bytes; /* byte scritti nei record (delta) */
+    FILE *stream;           /* file RLE o delta del processo */
+    FILE *index;            /* indice del file delta, una delta_entry per record */
+    long long offset;       /* byte già scritti nel file delta */
+    long written;           /* snapshot scritti */
+    long errors;            /* scritture fallite */
+    double stall_time;      /* tempo di calcolo perso in attesa di uno slot libero */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty, not_full;
+} snapshot_writer;
+
+/* richiesta di un client dell'endpoint di interrogazione, solo MASTER */
+typedef struct {
+    int fd;                 /* connessione su cui rispondere */
+    long long rect[4];      /* riga, colonna, righe e colonne del rettangolo */
+    int gen;                /* generazione della risposta */
+    char *cells;            /* celle del rettangolo per righe, NULL se la simulazione è terminata prima della raccolta */
+} query_request;
+
+/*
+endpoint di interrogazione: MASTER accetta le richieste su un socket Unix in un thread dedicato,
+ogni generazione i rettangoli vengono inviati a tutti i processi e le loro parti raccolte su MASTER
+*/
+typedef struct {
+    int rank, num_proc;
+    long long row_size, col_size;   /* dimensioni della matrice */
+    const int *rows_for_proc, *displ_for_proc; /* divisione delle righe fra i processi */
+    long long block[2][1 + 4 * QUERY_BATCH]; /* numero di rettangoli e rettangoli: in broadcast e in raccolta */
+    MPI_Request bcast, gather;      /* giri in corso */
+    bool bcast_active, gather_active;
+    char *send;                     /* parti dei rettangoli possedute dal processo */
+    char *recv;                     /* parti di tutti i processi, per processo (solo MASTER) */
+    int *counts, *displs;           /* celle ricevute da ogni processo (solo MASTER) */
+    /* solo MASTER */
+    const char *path;               /* percorso del socket */
+    int listen_fd;                  /* socket in ascolto */
+    int wake[2];                    /* pipe con cui il calcolo sveglia il thread */
+    query_request round[2][QUERY_BATCH]; /* richieste in broadcast e in raccolta */
+    query_request waiting[QUERY_QUEUE]; /* richieste accettate, non ancora inviate ai processi */
+    int waiting_count;
+    query_request ready[QUERY_QUEUE];   /* risposte che il thread deve scrivere */
+    int ready_count;
+    int outstanding;                /* richieste accettate e non ancora risposte */
+    long served, rejected;          /* rettangoli serviti e richieste rifiutate */
+    bool closing;                   /* richiesta di terminazione al thread */
+    pthread_t thread;
+    pthread_mutex_t lock;
+} query_server;
+
+/* raggio massimo delle regole Larger than Life */
+#define LTL_MAX_RADIUS 10
+
+/* 
+regola Larger than Life: la cella conta le celle vive nel quadrato di lato 2 * radius + 1
+centrato su di essa, nasce o sopravvive se il conteggio cade nell'intervallo corrispondente
+*/
+typedef struct {
+    int radius;                     /* raggio del vicinato */
+    bool middle;                    /* il conteggio comprende la cella stessa */
+    int birth_min, birth_max;       /* intervallo di nascita */
+    int survive_min, survive_max;   /* intervallo di sopravvivenza */
+} ltl_rule;
+
+/* B3/S23 come regola Larger than Life, regola di default del kernel ltl */
+#define CONWAY_LTL { 1, false, 3, 3, 2, 3 }
+
+/* 
+memoria di lavoro di un kernel legato con bind_kernel, riusata fra le chiamate.
+Le somme verticali del kernel ltl valgono per la riga sums_last - 1 di sums_origin:
+una chiamata che riprende da sums_last sullo stesso buffer prosegue da lì
+*/
+typedef struct {
+    int *sums;                  /* somme verticali per colonna del kernel ltl */
+    long long sums_cols;        /* colonne per cui è allocato sums */
+    const char *sums_origin;    /* buffer su cui sono state calcolate le somme */
+    int sums_last;              /* riga successiva all'ultima calcolata, 0 se le somme non valgono */
+    uint64_t *words;            /* tre righe impacchettate del kernel packed */
+    size_t word_count;          /* parole per riga allocate in words */
+} kernel_scratch;
+
+/* 
+kernel di calcolo: calcola le righe [first, last) della nuova generazione.
+origin e result indicano la prima riga posseduta, le righe da -radius a -1 e da rows
+a rows + radius - 1 sono le righe fantasma. La regola fa parte del kernel, quindi
+kernel con regole diverse possono essere usati insieme nello stesso processo
+*/
+typedef struct gol_kernel {
+    const char *name;
+    void (*compute)(const struct gol_kernel *kernel, const char *origin, char *result, int first, int last, long long cols);
+    life_rule life;     /* regola B/S del kernel lut, gli altri kernel di raggio 1 calcolano solo B3/S23 */
+    ltl_rule ltl;       /* regola del kernel ltl, il suo raggio dà le righe fantasma per lato */
+    kernel_scratch *scratch;    /* memoria di lavoro della copia legata, NULL nella tabella */
+} gol_kernel;
+
+/* matrice completa del motore sequenziale, con le righe fantasma come le porzioni */
+typedef struct {
+    int rows;               /* righe della matrice */
+    long long cols;         /* colonne della matrice */
+    int depth;              /* righe fantasma per lato */
+    char *buffers[2];       /* prima riga dei due buffer di generazione */
+    int current;            /* buffer della generazione corrente */
+} reference_board;
+
+typedef struct halo_exchange halo_exchange;
+
+/* posizione dei processi nell'anello delle righe */
+typedef struct {
+    MPI_Comm comm;          /* communicator dei processi dell'anello */
+    int *order;             /* rank in ogni posizione dell'anello */
+    int *position;          /* posizione nell'anello di ogni rank */
+    int nodes, sockets;     /* nodi e socket occupati dai processi */
+    int cross_node[2];      /* archi dell'anello fra nodi diversi, in ordine di rank e nell'ordine scelto */
+    int cross_socket[2];    /* archi dell'anello fra socket diversi, in ordine di rank e nell'ordine scelto */
+} ring_placement;
+
+/* backend di scambio delle righe di bordo */
+typedef struct {
+    const char *name;
+    bool overlap;       /* lo scambio avanza mentre si calcolano le righe interne */
+    bool (*open)(halo_exchange *halo, grid_arena *arena);   /* prepara i due buffer di generazione */
+    void (*start)(halo_exchange *halo, char *buffer);       /* avvia lo scambio delle righe di bordo del buffer */
+    bool (*progress)(halo_exchange *halo);                  /* fa avanzare lo scambio, true se completato */
+    void (*finish)(halo_exchange *halo);                    /* completa lo scambio */
+    void (*close)(halo_exchange *halo);
+} halo_backend;
+
+/* scambio delle righe di bordo fra processi adiacenti nell'anello */
+struct halo_exchange {
+    const halo_backend *backend;
+    MPI_Datatype row_data;  /* datatype che indica una riga della matrice */
+    int rank;               /* rank del processo corrente */
+    const ring_placement *place; /* posizione dei processi nell'anello */
+    MPI_Comm comm;          /* communicator dei processi dell'anello */
+    int rows;               /* righe possedute */
+    long long cols;         /* colonne della matrice */
+    int depth;              /* righe fantasma per lato */
+    int prev_rank, next_rank; /* processi adiacenti nel toroide */
+    int prev_rows;          /* righe possedute dal processo precedente */
+    char *buffers[2];       /* prima riga posseduta dei due buffer di generazione */
+    int current;            /* buffer dello scambio in corso */
+    MPI_Request requests[4]; /* ricezioni e invii in corso (ring) */
+    MPI_Win windows[2];     /* finestre sui due buffer (rma, shm) */
+    MPI_Comm node;          /* processi sullo stesso nodo (shm) */
+    char *peer_prev[2], *peer_next[2]; /* prima riga posseduta dei buffer dei vicini (shm) */
+    unsigned char *packed[4]; /* righe codificate: ricezioni dal precedente e dal successivo, poi invii (compact) */
+    int packed_size;        /* dimensione massima di un messaggio di depth righe codificate (compact), al più INT_MAX */
+    long long sent_bytes;   /* byte inviati dopo la codifica (compact) */
+    long long messages[2];  /* righe inviate con codifica HALO_SPARSE e HALO_DENSE (compact) */
+};
+
+/* avanzamento delle comunicazioni delle righe di bordo durante il calcolo delle righe interne */
+typedef struct {
+    int mode;               /* una delle modalità PROGRESS_* */
+    int rows;               /* righe interne fra due chiamate di avanzamento */
+    MPI_Comm comm;          /* communicator duplicato su cui il thread chiama MPI_Iprobe */
+    bool active;            /* il thread principale sta calcolando le righe interne */
+    bool closing;           /* richiesta di terminazione al thread */
+    long polls;             /* chiamate MPI eseguite per far avanzare le comunicazioni */
+    band_stream *stream;    /* calcolo per bande fuori memoria, NULL se la porzione è in memoria */
+    double compute_time;    /* tempo speso nel calcolo delle righe interne */
+    double wait_time;       /* tempo speso in attesa delle righe di bordo dopo il calcolo */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} halo_progress;
+
+/* statistiche di una generazione, accumulate durante la computazione */
+typedef struct {
+    long long live;     /* celle vive */
+    long long births;   /* celle nate rispetto alla generazione precedente */
+    long long deaths;   /* celle morte rispetto alla generazione precedente */
+    long long min_row, min_col, max_row, max_col; /* bounding box delle celle vive */
+    uint64_t hash;      /* hash delle celle vive, indipendente dalla divisione fra processi */
+} gen_stats;
+
+/* verifica del motore parallelo rispetto al motore sequenziale, eseguito da MASTER */
+typedef struct {
+    const gol_kernel *kernel;   /* kernel del riferimento */
+    reference_board board;      /* matrice di riferimento, solo MASTER */
+    gen_stats stats;            /* statistiche della generazione corrente del riferimento, solo MASTER */
+    int gen;                    /* generazione corrente del riferimento */
+    int checked;                /* generazioni confrontate con esito positivo */
+    int failed_gen;             /* prima generazione diversa, -1 se nessuna */
+    long long failed_cell;      /* indice della prima cella diversa, -1 se nessuna, solo MASTER */
+    char expected, actual;      /* stato della prima cella diversa nel riferimento e nel motore parallelo */
+} verifier;
+
+/* riduzione non bloccante delle statistiche di una generazione fra tutti i processi */
+typedef struct {
+    unsigned long long counters[4], counters_out[4]; /* live, births, deaths, hash: sommati */
+    long long bounds[4], bounds_out[4];     /* min_row, min_col, -max_row, -max_col: minimo */
+    MPI_Request requests[2];                /* request delle due MPI_Iallreduce */
+    int gen;                                /* generazione a cui si riferisce la riduzione */
+    bool pending;                           /* indica una riduzione in corso */
+    long long origin[2];                    /* riga e colonna nel piano della cella (0, 0), per il file delle statistiche */
+} stats_reduction;
+
+/* esito del controllo di terminazione anticipata */
+#define CYCLE_NONE 0        /* l'evoluzione prosegue */
+#define CYCLE_EXTINCTION -1 /* nessuna cella viva */
+
+/* finestra degli hash delle ultime generazioni, usata per riconoscere stati ripetuti */
+typedef struct {
+    int period;         /* periodo massimo da riconoscere */
+    uint64_t *hashes;   /* hash delle ultime period + 1 generazioni, indicizzati per generazione */
+    int seen;           /* generazioni inserite nella finestra */
+} cycle_window;
+
+/* piano illimitato: celle vive più vicine di UNBOUNDED_MARGIN al bordo della finestra la fanno crescere */
+#define UNBOUNDED_MARGIN 4
+/* righe e colonne morte aggiunte attorno alle celle vive, oltre a un quarto delle loro dimensioni */
+#define UNBOUNDED_PAD 16
+/* la finestra si riduce se la sua area supera di UNBOUNDED_SHRINK volte quella necessaria */
+#define UNBOUNDED_SHRINK 4
+
+/* finestra del piano illimitato simulata sul toroide, con bordi sempre morti */
+typedef struct {
+    long long origin_row, origin_col; /* posizione nel piano della cella (0, 0) della finestra */
+    long long rows, cols;             /* dimensioni della finestra */
+    int radius;                       /* raggio del vicinato: margini e bordi sono multipli del raggio */
+    long long next_rows, next_cols;   /* dimensioni della finestra scelta da unbounded_fit */
+    long long shift_row, shift_col;   /* posizione della nuova finestra rispetto alla corrente */
+    int resizes;                      /* ridimensionamenti eseguiti */
+    long long max_cells;              /* area della finestra più grande */
+} unbounded_domain;
+
+
+/* 
+* @brief Mescola i bit di un intero a 64 bit (finalizzatore di splitmix64)
+* 
+* Usata come generatore pseudo-casuale indicizzato: lo stesso valore in ingresso
+* produce sempre lo stesso risultato, indipendentemente dal processo che lo calcola.
+* 
+* @param x valore da mescolare
+* @return valore mescolato
+*/
+static inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/*
+* @brief Scrive un intero senza segno in formato varint, 7 bit per byte
+* 
+* @param out destinazione, almeno 10 byte
+* @param value valore da scrivere
+* @return numero di byte scritti
+*/
+static inline int put_varint(unsigned char *out, unsigned long long value) {
+    int n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+/*
+* @brief Legge un intero in formato varint e avanza il puntatore
+*/
+static inline unsigned long long get_varint(const unsigned char **in) {
+    unsigned long long value = 0;
+    int shift = 0;
+    while (**in & 0x80) {
+        value |= (unsigned long long)(*(*in)++ & 0x7f) << shift;
+        shift += 7;
+    }
+    value |= (unsigned long long)*(*in)++ << shift;
+    return value;
+}
+
+
+/* gol_memory.c */
+void *checked_alloc(size_t count, size_t size);
+void make_row_type(long long cols, MPI_Datatype *row_type);
+void split_rows(long long row_size, int num_proc, const int *order, int *rows_for_proc, int *displ_for_proc);
+bool arena_open(grid_arena *arena, size_t size, bool huge_pages);
+char *arena_take(grid_arena *arena, size_t size);
+void arena_close(grid_arena *arena);
+bool arena_open_file(grid_arena *arena, size_t size, const char *dir);
+
+/* gol_stream.c */
+void stream_open(band_stream *stream, const grid_arena *arena, int band_rows, int rows, long long cols, int depth);
+void stream_begin(band_stream *stream, char *origin, char *result, int first, int end);
+void stream_rows(band_stream *stream, const gol_kernel *kernel, int first, int last, long long first_row, gen_stats *stats);
+bool stream_seed(band_stream *stream, seed_options *seed, char *buffer, long long first_row, long long row_size);
+void stream_release(band_stream *stream, char *buffer);
+
+/* gol_seed.c */
+void print_matrix(int gen, char *mat, int rows, long long cols);
+void init_from_file(char *mat, long long rows, long long cols, char *file);
+void init_test_matrix(char *mat, long long rows, long long cols);
+void check_matrix_size(char *filename, long long *row_size, long long *col_size);
+char *pattern_path(char *name);
+char *load_pattern(char *name, int *rows, int *cols);
+void init_random(char *mat, long long first_row, int rows, long long cols, double density, uint64_t seed);
+void init_tiled(char *mat, long long first_row, int rows, long long cols, char *pattern, int pat_rows, int pat_cols);
+void init_scattered(char *mat, long long first_row, int rows, long long row_size, long long col_size,
+                    char *pattern, int pat_rows, int pat_cols, long copies, uint64_t seed);
+bool seed_slab(seed_options *seed, char *mat, long long first_row, int rows, long long row_size, long long col_size);
+
+/* gol_options.c */
+int parse_options(int argc, char **argv, gol_options *opt);
+
+/* gol_stats.c */
+void reset_stats(gen_stats *stats);
+void row_stats(const char *before, const char *after, long long cols, long long row, gen_stats *stats);
+void slab_stats(char *buffer, int rows, long long cols, long long first_row, gen_stats *stats);
+int check_cycle(cycle_window *window, unsigned long long live, uint64_t hash);
+void start_stats(stats_reduction *red, gen_stats *local, int gen);
+void print_stats(FILE *out, int gen, unsigned long long live, unsigned long long births, unsigned long long deaths,
+                 const long long *bounds);
+void finish_stats(stats_reduction *red, FILE *out);
+
+/* gol_kernel.c */
+const gol_kernel *find_kernel(const char *name);
+bool bind_kernel(gol_kernel *kernel, const char *name, const ltl_rule *rule);
+void unbind_kernel(gol_kernel *kernel);
+bool parse_rule(const char *text, life_rule *rule);
+int kernel_radius(const gol_kernel *kernel);
+void compute_rows(const gol_kernel *kernel, char *origin, char *result, int first, int last,
+                  long long cols, long long first_row, gen_stats *stats);
+
+/* gol_ltl.c */
+bool parse_ltl(const char *spec, ltl_rule *rule);
+void compute_ltl(const gol_kernel *kernel, const char *origin_buff, char *result_buffer, int first, int last, long long col_size);
+
+/* gol_halo.c */
+const halo_backend *find_halo(const char *name);
+bool halo_open(halo_exchange *halo, const halo_backend *backend, grid_arena *arena, MPI_Datatype row_data,
+               int rank, int num_proc, const ring_placement *place, int *rows_for_proc, long long cols, int depth);
+void halo_close(halo_exchange *halo);
+void progress_open(halo_progress *prog, const halo_exchange *halo, int mode, int rows);
+void progress_compute(halo_progress *prog, halo_exchange *halo, const gol_kernel *kernel, char *origin_buff,
+                      char *result_buffer, long long first_row, gen_stats *stats);
+void progress_wait(halo_progress *prog, halo_exchange *halo);
+void progress_close(halo_progress *prog);
+
+/* gol_reference.c */
+void reference_open(reference_board *board, int rows, long long cols, int depth);
+void reference_step(reference_board *board, const gol_kernel *kernel, gen_stats *stats);
+void reference_close(reference_board *board);
+void run_sequential(gol_options *opt, const gol_kernel *kernel);
+
+/* gol_verify.c */
+void verify_open(verifier *check, const gol_kernel *kernel, int rank, char *slab, long long row_size, long long col_size,
+                 int *rows_for_proc, int *displ_for_proc, MPI_Datatype row_data);
+bool verify_generation(verifier *check, int rank, int gen, unsigned long long live, uint64_t hash, char *slab,
+                       int *rows_for_proc, int *displ_for_proc, MPI_Datatype row_data);
+bool verify_close(verifier *check, int rank);
+
+/* gol_unbounded.c */
+void unbounded_open(unbounded_domain *domain, long long rows, long long cols, int radius);
+void unbounded_bounds(gen_stats *stats, unsigned long long *live, long long *bounds);
+bool unbounded_fit(unbounded_domain *domain, unsigned long long live, const long long *bounds, int num_proc);
+void unbounded_resize(unbounded_domain *domain, halo_exchange *halo, grid_arena *arena, bool huge_pages, MPI_Datatype *row_data,
+                      int rank, int num_proc, int *rows_for_proc, int *displ_for_proc, char *slab, gen_stats *stats);
+
+/* gol_topology.c */
+void placement_open(ring_placement *place, MPI_Comm comm, bool topology);
+void placement_close(ring_placement *place);
+
+/* gol_ensemble.c */
+void run_ensemble(int rank, gol_options *opt, int threads);
+
+/* gol_snapshot.c */
+bool snapshot_open(snapshot_writer *writer, gol_options *opt, int rank, int num_proc, int rows, long long cols, long long first_row, long long row_size);
+void snapshot_push(snapshot_writer *writer, int gen, const char *slab);
+void snapshot_close(snapshot_writer *writer);
+void pack_rows(const char *slab, int rows, long long cols, unsigned char *out);
+
+/* porzione di un processo nella storia registrata: file delta e indice mappati in memoria */
+typedef struct {
+    const unsigned char *data;  /* file delta */
+    size_t size;
+    const delta_entry *entries; /* indice */
+    long long count;            /* record nell'indice */
+    size_t index_size;
+    long long first_row;        /* indice globale della prima riga della porzione */
+    int rows;                   /* righe della porzione */
+} history_part;
+
+/* storia registrata con --snapshot-format=delta: un file delta e un indice per processo */
+typedef struct {
+    history_part *parts;
+    int part_count;
+    int num_proc;               /* processi dell'esecuzione registrata */
+    long long row_size, cols;   /* dimensioni della matrice */
+    int keyframe_every;         /* snapshot fra due keyframe */
+    int applied;                /* record applicati dall'ultima ricerca, keyframe compreso */
+} history_store;
+
+/* gol_history.c */
+bool history_open(history_store *store, const char *prefix);
+bool history_seek(history_store *store, int gen, char *board);
+void history_close(history_store *store);
+void run_seek(gol_options *opt);
+
+/* gol_tune.c */
+void autotune(tune_choice *choice, const gol_options *opt, const ltl_rule *rule, const halo_exchange *halo, int *rows_for_proc,
+              long long row_size, const char *slab, int thread_level);
+
+/* gol_query.c */
+bool query_open(query_server *server, const char *path, int rank, int num_proc, long long row_size, long long col_size,
+                const int *rows_for_proc, const int *displ_for_proc);
+void query_step(query_server *server, int gen, const char *slab);
+void query_close(query_server *server);
+
+/* gol_viewport.c */
+bool viewport_open(viewport *view, gol_options *opt, int rank, int num_proc, long long row_size, long long col_size,
+                   int *rows_for_proc, int *displ_for_proc);
+void viewport_frame(viewport *view, int rank, int gen, const char *slab, int rows, long long first_row);
+void viewport_close(viewport *view);
+
+#endif
@@ -0,0 +1,563 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Modalità ensemble: molte board piccole e indipendenti simulate in un solo job
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "gol_engine.h"
+
+/*
+ * @brief Scrive una regola in notazione B/S
+ * 
+ * @param rule regola da scrivere
+ * @param text buffer di almeno 22 caratteri
+ */
+static void format_rule(life_rule rule, char *text) {
+    *text++ = 'B';
+    for (int k = 0; k <= 8; k++) {
+        if (rule.birth & (1 << k)) { *text++ = '0' + k; }
+    }
+    *text++ = '/';
+    *text++ = 'S';
+    for (int k = 0; k <= 8; k++) {
+        if (rule.survive & (1 << k)) { *text++ = '0' + k; }
+    }
+    *text = '\0';
+}
+
+/*
+* @brief Calcola la generazione successiva di un'intera board toroidale locale
+* 
+* Usata dalla modalità ensemble, dove ogni board è simulata da un solo thread
+* senza righe di bordo da scambiare. Le colonne di bordo vengono trattate a parte
+* per evitare il modulo nel ciclo interno.
+*
+* @param src board di partenza
+* @param dst board su cui memorizzare la nuova generazione
+* @param rows numero di righe della board
+* @param cols numero di colonne della board
+* @param rule regola di evoluzione
+* @param hash indirizzo in cui memorizzare l'hash delle celle vive
+* @return numero di celle vive nella nuova generazione
+*/
+static long long step_board(const char *src, char *dst, int rows, int cols, life_rule rule, uint64_t *hash) {
+    long long live = 0;
+    uint64_t sum = 0;
+    for (int i = 0; i < rows; i++) {
+        /* righe sopra e sotto, tenendo conto del toroide */
+        const char *up = src + (size_t)((i + rows - 1) % rows) * cols;
+        const char *row = src + (size_t)i * cols;
+        const char *down = src + (size_t)((i + 1) % rows) * cols;
+        for (int j = 0; j < cols; j++) {
+            int left = j > 0 ? j - 1 : cols - 1;
+            int right = j < cols - 1 ? j + 1 : 0;
+            int live_count = (up[left] == ALIVE) + (up[j] == ALIVE) + (up[right] == ALIVE)
+                           + (row[left] == ALIVE) + (row[right] == ALIVE)
+                           + (down[left] == ALIVE) + (down[j] == ALIVE) + (down[right] == ALIVE);
+            uint16_t mask = row[j] == ALIVE ? rule.survive : rule.birth;
+            if ((mask >> live_count) & 1) {
+                dst[(size_t)i * cols + j] = ALIVE;
+                live++;
+                sum += mix64(mix64(i) ^ j);
+            } else {
+                dst[(size_t)i * cols + j] = DEAD;
+            }
+        }
+    }
+    *hash = sum;
+    return live;
+}
+
+/*
+ * @brief Legge la lista di board della modalità ensemble
+ * 
+ * Ogni riga non vuota e non commentata (#) descrive una board:
+ * righe colonne generazioni densità seme [regola]
+ * 
+ * @param filename file da leggere
+ * @param count indirizzo in cui memorizzare il numero di board lette
+ * @return board lette, NULL in caso di errore
+ */
+static ensemble_job *load_ensemble(char *filename, long *count) {
+    FILE *file = fopen(filename, "r");
+    ensemble_job *jobs = NULL;
+    long size = 0, capacity = 0;
+    char line[256], rule[64];
+
+    *count = 0;
+    if (file == NULL) {
+        return NULL;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        ensemble_job job;
+        unsigned long long seed;
+        life_rule conway = CONWAY_RULE;
+        char *start = line;
+        while (isspace((unsigned char)*start)) { start++; }
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+        int fields = sscanf(start, "%d %d %d %lf %llu %63s", &job.rows, &job.cols, &job.generations, &job.density, &seed, rule);
+        job.seed = seed;
+        job.rule = conway;
+        if (fields < 5 || (fields == 6 && !parse_rule(rule, &job.rule)) || job.rows < 1 || job.cols < 1 || job.generations < 0) {
+            free(jobs);
+            fclose(file);
+            return NULL;
+        }
+        if (size == capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 64;
+            ensemble_job *grown = realloc(jobs, capacity * sizeof(ensemble_job));
+            if (grown == NULL) {
+                free(jobs);
+                fclose(file);
+                return NULL;
+            }
+            jobs = grown;
+        }
+        jobs[size++] = job;
+    }
+    fclose(file);
+    *count = size;
+    return jobs;
+}
+
+/*
+* @brief Calcola la generazione successiva di fino a 64 board toroidali della stessa dimensione
+*
+* Il bit k di ogni parola è la cella della board k: i vicini vengono sommati con
+* addizionatori completi sulle parole intere, quindi ogni operazione avanza tutte le
+* board insieme. Le regole possono differire: per ogni numero di vicini n, birth[n] e
+* survive[n] indicano le board la cui regola fa nascere o sopravvivere una cella.
+*
+* @param src board di partenza
+* @param dst board su cui memorizzare la nuova generazione
+* @param rows numero di righe delle board
+* @param cols numero di colonne delle board
+* @param birth board per cui n vicini fanno nascere una cella, per n da 0 a 8
+* @param survive board per cui n vicini fanno sopravvivere una cella, per n da 0 a 8
+*/
+static void step_sliced(const uint64_t *src, uint64_t *dst, int rows, int cols, const uint64_t *birth, const uint64_t *survive) {
+    for (int i = 0; i < rows; i++) {
+        const uint64_t *up = src + (size_t)((i + rows - 1) % rows) * cols;
+        const uint64_t *row = src + (size_t)i * cols;
+        const uint64_t *down = src + (size_t)((i + 1) % rows) * cols;
+        for (int j = 0; j < cols; j++) {
+            int left = j > 0 ? j - 1 : cols - 1;
+            int right = j < cols - 1 ? j + 1 : 0;
+            /* tre gruppi di vicini sommati a 2 bit: somme s e riporti c */
+            uint64_t a = up[left], b = up[j], c = up[right];
+            uint64_t s0 = a ^ b ^ c, c0 = (a & b) | (c & (a ^ b));
+            a = row[left]; b = row[right]; c = down[left];
+            uint64_t s1 = a ^ b ^ c, c1 = (a & b) | (c & (a ^ b));
+            a = down[j]; b = down[right];
+            uint64_t s2 = a ^ b, c2 = a & b;
+            /* bit di peso 1, 2, 4 e 8 del numero di vicini */
+            uint64_t bit0 = s0 ^ s1 ^ s2, c3 = (s0 & s1) | (s2 & (s0 ^ s1));
+            uint64_t t = c0 ^ c1 ^ c2, c4 = (c0 & c1) | (c2 & (c0 ^ c1));
+            uint64_t bit1 = t ^ c3, c5 = t & c3;
+            uint64_t bit2 = c4 ^ c5, bit3 = c4 & c5;
+
+            uint64_t alive = row[j], next = 0;
+            for (int n = 0; n <= 8; n++) {
+                uint64_t rule = (alive & survive[n]) | (~alive & birth[n]);
+                if (rule == 0) {
+                    continue;
+                }
+                uint64_t match = (n & 1 ? bit0 : ~bit0) & (n & 2 ? bit1 : ~bit1)
+                               & (n & 4 ? bit2 : ~bit2) & (n & 8 ? bit3 : ~bit3);
+                next |= match & rule;
+            }
+            dst[(size_t)i * cols + j] = next;
+        }
+    }
+}
+
+/*
+* @brief Celle vive e hash di ogni board di un gruppo bit-sliced
+*
+* Le celle vive vengono contate con un contatore verticale: ogni parola viene sommata
+* a piani di bit in cui il bit k del piano b è il bit b del conteggio della board k,
+* e al termine i conteggi vengono ricomposti dai piani. L'hash, uguale a quello di
+* step_board, viene calcolato solo per le board indicate.
+*
+* @param board board del gruppo
+* @param rows numero di righe delle board
+* @param cols numero di colonne delle board
+* @param hashed board di cui calcolare l'hash
+* @param live celle vive di ogni board
+* @param hash hash di ogni board indicata
+*/
+static void sliced_stats(const uint64_t *board, int rows, int cols, uint64_t hashed, long long *live, uint64_t *hash) {
+    uint64_t planes[64] = { 0 };
+    int used = 0;
+    memset(hash, 0, ENSEMBLE_LANES * sizeof(uint64_t));
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            uint64_t word = board[(size_t)i * cols + j], carry = word;
+            int b = 0;
+            for (; carry != 0; b++) {
+                uint64_t next = planes[b] & carry;
+                planes[b] ^= carry;
+                carry = next;
+            }
+            used = b > used ? b : used;
+            uint64_t lanes = word & hashed;
+            if (lanes != 0) {
+                uint64_t value = mix64(mix64(i) ^ j);
+                for (; lanes != 0; lanes &= lanes - 1) {
+                    hash[__builtin_ctzll(lanes)] += value;
+                }
+            }
+        }
+    }
+    for (int k = 0; k < ENSEMBLE_LANES; k++) {
+        live[k] = 0;
+        for (int b = 0; b < used; b++) {
+            live[k] |= (long long)((planes[b] >> k) & 1) << b;
+        }
+    }
+}
+
+/* stato condiviso fra i thread di un processo nella modalità ensemble */
+typedef struct {
+    ensemble_job *jobs;             /* board da simulare */
+    long count;                     /* numero di board */
+    long *order;                    /* board ordinate per dimensione, per il motore bit-sliced */
+    long *groups;                   /* inizio in order di ogni gruppo bit-sliced, più la fine */
+    long group_count;               /* gruppi bit-sliced, 0 se si usa il motore scalare */
+    unsigned long long *results;    /* ENSEMBLE_FIELDS valori per board */
+    int stop_period;                /* terminazione anticipata per singola board */
+    MPI_Win counter;                /* indice della prossima board, memorizzato su MASTER */
+    pthread_mutex_t lock;           /* serializza le chiamate MPI dei thread */
+} ensemble_context;
+
+/*
+ * @brief Simula una board della modalità ensemble dall'inizio alla fine
+ * 
+ * @param job board da simulare
+ * @param stop_period periodo massimo per la terminazione anticipata, 0 se disabilitata
+ * @param result ENSEMBLE_FIELDS valori: generazioni calcolate, celle vive, esito, hash finale
+ */
+static void run_ensemble_job(ensemble_job *job, int stop_period, unsigned long long *result) {
+    size_t cells = (size_t)job->rows * job->cols;
+    char *board = checked_alloc(cells, 1), *next = checked_alloc(cells, 1), *temp;
+    cycle_window window = { stop_period, NULL, 0 };
+    gen_stats stats;
+    int cycle = CYCLE_NONE, gen = 0;
+    long long live;
+    uint64_t hash;
+
+    init_random(board, 0, job->rows, job->cols, job->density, job->seed);
+    slab_stats(board, job->rows, job->cols, 0, &stats);
+    live = stats.live;
+    hash = stats.hash;
+    if (stop_period > 0) {
+        window.hashes = checked_alloc(stop_period + 1, sizeof(uint64_t));
+        memset(window.hashes, 0, (stop_period + 1) * sizeof(uint64_t));
+        cycle = check_cycle(&window, live, hash);
+    }
+    while (cycle == CYCLE_NONE && gen < job->generations) {
+        live = step_board(board, next, job->rows, job->cols, job->rule, &hash);
+        temp = board;
+        board = next;
+        next = temp;
+        gen++;
+        if (stop_period > 0) {
+            cycle = check_cycle(&window, live, hash);
+        }
+    }
+    result[0] = gen;
+    result[1] = live;
+    result[2] = (unsigned long long)(long long)cycle;
+    result[3] = hash;
+    free(window.hashes);
+    free(board);
+    free(next);
+}
+
+/*
+ * @brief Simula insieme un gruppo di board della stessa dimensione con il motore bit-sliced
+ * 
+ * Ogni board termina alla propria generazione o alla propria terminazione anticipata:
+ * da lì i suoi bit continuano a cambiare ma i risultati sono già stati registrati,
+ * uguali a quelli di run_ensemble_job. Il gruppo termina con l'ultima board attiva.
+ * 
+ * @param ctx contesto condiviso del processo
+ * @param group indice del gruppo
+ */
+static void run_sliced_group(ensemble_context *ctx, long group) {
+    const long *members = ctx->order + ctx->groups[group];
+    int lanes = (int)(ctx->groups[group + 1] - ctx->groups[group]);
+    int rows = ctx->jobs[members[0]].rows, cols = ctx->jobs[members[0]].cols;
+    size_t cells = (size_t)rows * cols;
+    uint64_t *board = checked_alloc(cells, sizeof(uint64_t)), *next = checked_alloc(cells, sizeof(uint64_t)), *temp;
+    char *seed = checked_alloc(cells, 1);
+    uint64_t birth[9] = { 0 }, survive[9] = { 0 }, active = 0, hash[ENSEMBLE_LANES];
+    long long live[ENSEMBLE_LANES];
+    cycle_window windows[ENSEMBLE_LANES];
+    int gen = 0;
+
+    memset(board, 0, cells * sizeof(uint64_t));
+    for (int k = 0; k < lanes; k++) {
+        ensemble_job *job = &ctx->jobs[members[k]];
+        init_random(seed, 0, rows, cols, job->density, job->seed);
+        for (size_t c = 0; c < cells; c++) {
+            board[c] |= (uint64_t)(seed[c] == ALIVE) << k;
+        }
+        for (int n = 0; n <= 8; n++) {
+            birth[n] |= (uint64_t)((job->rule.birth >> n) & 1) << k;
+            survive[n] |= (uint64_t)((job->rule.survive >> n) & 1) << k;
+        }
+        windows[k].period = ctx->stop_period;
+        windows[k].hashes = NULL;
+        if (ctx->stop_period > 0) {
+            windows[k].hashes = checked_alloc(ctx->stop_period + 1, sizeof(uint64_t));
+            memset(windows[k].hashes, 0, (ctx->stop_period + 1) * sizeof(uint64_t));
+        }
+        windows[k].seen = 0;
+        active |= 1ULL << k;
+    }
+    free(seed);
+
+    for (;;) {
+        /* l'hash serve alle board che terminano ora o che cercano stati ripetuti */
+        uint64_t hashed = 0;
+        for (int k = 0; k < lanes; k++) {
+            if (((active >> k) & 1) && (ctx->stop_period > 0 || gen == ctx->jobs[members[k]].generations)) {
+                hashed |= 1ULL << k;
+            }
+        }
+        sliced_stats(board, rows, cols, hashed, live, hash);
+        for (int k = 0; k < lanes; k++) {
+            if (!((active >> k) & 1)) {
+                continue;
+            }
+            int cycle = ctx->stop_period > 0 ? check_cycle(&windows[k], live[k], hash[k]) : CYCLE_NONE;
+            if (cycle != CYCLE_NONE || gen == ctx->jobs[members[k]].generations) {
+                unsigned long long *result = ctx->results + members[k] * ENSEMBLE_FIELDS;
+                result[0] = gen;
+                result[1] = live[k];
+                result[2] = (unsigned long long)(long long)cycle;
+                result[3] = hash[k];
+                active &= ~(1ULL << k);
+            }
+        }
+        if (active == 0) {
+            break;
+        }
+        step_sliced(board, next, rows, cols, birth, survive);
+        temp = board;
+        board = next;
+        next = temp;
+        gen++;
+    }
+    for (int k = 0; k < lanes; k++) {
+        free(windows[k].hashes);
+    }
+    free(board);
+    free(next);
+}
+
+/* dimensione e posizione di una board, per l'ordinamento dei gruppi bit-sliced */
+typedef struct {
+    int rows, cols;
+    long index;
+} job_key;
+
+/*
+ * @brief Ordina le board per dimensione, a parità di dimensione per posizione nella lista
+ */
+static int compare_jobs(const void *a, const void *b) {
+    const job_key *x = a, *y = b;
+    if (x->rows != y->rows) {
+        return x->rows < y->rows ? -1 : 1;
+    }
+    if (x->cols != y->cols) {
+        return x->cols < y->cols ? -1 : 1;
+    }
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/*
+ * @brief Divide le board in gruppi bit-sliced di al più ENSEMBLE_LANES board della stessa dimensione
+ * 
+ * Ogni processo calcola gli stessi gruppi dalla stessa lista, senza comunicazioni.
+ * 
+ * @param ctx contesto del processo, con la lista delle board
+ */
+static void build_groups(ensemble_context *ctx) {
+    job_key *keys = checked_alloc(ctx->count, sizeof(job_key));
+    ctx->order = checked_alloc(ctx->count, sizeof(long));
+    ctx->groups = checked_alloc(ctx->count + 1, sizeof(long));
+    for (long b = 0; b < ctx->count; b++) {
+        keys[b] = (job_key){ ctx->jobs[b].rows, ctx->jobs[b].cols, b };
+    }
+    qsort(keys, ctx->count, sizeof(job_key), compare_jobs);
+    for (long b = 0; b < ctx->count; b++) {
+        ctx->order[b] = keys[b].index;
+    }
+    free(keys);
+    ctx->group_count = 0;
+    for (long b = 0; b < ctx->count; b++) {
+        long start = b > 0 ? ctx->groups[ctx->group_count - 1] : 0;
+        const ensemble_job *first = &ctx->jobs[ctx->order[start]], *job = &ctx->jobs[ctx->order[b]];
+        if (b == 0 || b - start == ENSEMBLE_LANES || job->rows != first->rows || job->cols != first->cols) {
+            ctx->groups[ctx->group_count++] = b;
+        }
+    }
+    ctx->groups[ctx->group_count] = ctx->count;
+}
+
+/*
+ * @brief Corpo dei thread della modalità ensemble
+ * 
+ * Ogni thread preleva la prossima board, o il prossimo gruppo bit-sliced, con
+ * MPI_Fetch_and_op sul contatore globale: le board vengono distribuite dinamicamente
+ * fra tutti i thread di tutti i processi e chi termina prima ne preleva di nuove.
+ * 
+ * @param arg contesto condiviso del processo
+ */
+static void *ensemble_worker(void *arg) {
+    ensemble_context *ctx = arg;
+    const long one = 1;
+    long index;
+    for (;;) {
+        pthread_mutex_lock(&ctx->lock);
+        MPI_Fetch_and_op(&one, &index, MPI_LONG, MASTER, 0, MPI_SUM, ctx->counter);
+        MPI_Win_flush(MASTER, ctx->counter);
+        pthread_mutex_unlock(&ctx->lock);
+        if (ctx->group_count > 0) {
+            if (index >= ctx->group_count) {
+                break;
+            }
+            run_sliced_group(ctx, index);
+            continue;
+        }
+        if (index >= ctx->count) {
+            break;
+        }
+        run_ensemble_job(&ctx->jobs[index], ctx->stop_period, ctx->results + index * ENSEMBLE_FIELDS);
+    }
+    return NULL;
+}
+
+/*
+ * @brief Esegue la modalità ensemble: molte board piccole e indipendenti in un solo job
+ * 
+ * MASTER legge la lista e la invia a tutti i processi, ogni processo avvia i suoi thread
+ * che prelevano board dal contatore globale, infine MASTER raccoglie i risultati.
+ * 
+ * @param rank rank del processo corrente
+ * @param opt opzioni da riga di comando
+ * @param threads thread da avviare nel processo corrente
+ */
+void run_ensemble(int rank, gol_options *opt, int threads) {
+    ensemble_context ctx;
+    long *next_job;
+    unsigned long long *all_results = NULL;
+    double start_time = MPI_Wtime();
+
+    if (rank == MASTER) {
+        ctx.jobs = load_ensemble(opt->ensemble_file, &ctx.count);
+        if (ctx.jobs == NULL) {
+            printf("Error, cannot read ensemble list %s.\n", opt->ensemble_file);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        printf("Ensemble: %ld boards\n", ctx.count);
+    }
+    MPI_Bcast(&ctx.count, 1, MPI_LONG, MASTER, MPI_COMM_WORLD);
+    if (rank != MASTER) {
+        ctx.jobs = checked_alloc(ctx.count, sizeof(ensemble_job));
+    }
+    /* a blocchi di ENSEMBLE_CHUNK board, perché il conteggio di una collettiva è un int */
+    for (long b = 0; b < ctx.count; b += ENSEMBLE_CHUNK) {
+        long n = ctx.count - b < ENSEMBLE_CHUNK ? ctx.count - b : ENSEMBLE_CHUNK;
+        MPI_Bcast(ctx.jobs + b, (int)(n * sizeof(ensemble_job)), MPI_BYTE, MASTER, MPI_COMM_WORLD);
+    }
+
+    /* con il motore bit-sliced il contatore globale scorre i gruppi invece delle board */
+    ctx.order = ctx.groups = NULL;
+    ctx.group_count = 0;
+    if (opt->ensemble_sliced) {
+        build_groups(&ctx);
+        if (rank == MASTER) {
+            printf("Ensemble: %ld bit-sliced groups of up to %d boards\n", ctx.group_count, ENSEMBLE_LANES);
+        }
+    }
+
+    /* ogni processo scrive solo i risultati delle sue board, gli altri restano a zero */
+    ctx.results = checked_alloc(ctx.count * ENSEMBLE_FIELDS, sizeof(unsigned long long));
+    memset(ctx.results, 0, ctx.count * ENSEMBLE_FIELDS * sizeof(unsigned long long));
+    ctx.stop_period = opt->stop_period;
+    pthread_mutex_init(&ctx.lock, NULL);
+
+    /* contatore globale delle board, esposto solo da MASTER */
+    MPI_Win_allocate(rank == MASTER ? sizeof(long) : 0, sizeof(long), MPI_INFO_NULL, MPI_COMM_WORLD, &next_job, &ctx.counter);
+    if (rank == MASTER) {
+        *next_job = 0;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Win_lock_all(0, ctx.counter);
+
+    pthread_t *workers = checked_alloc(threads, sizeof(pthread_t));
+    for (int t = 1; t < threads; t++) {
+        pthread_create(&workers[t], NULL, ensemble_worker, &ctx);
+    }
+    ensemble_worker(&ctx);
+    for (int t = 1; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    free(workers);
+
+    MPI_Win_unlock_all(ctx.counter);
+    MPI_Win_free(&ctx.counter);
+    pthread_mutex_destroy(&ctx.lock);
+
+    /* ogni board è stata simulata da un solo processo: la somma raccoglie tutti i risultati */
+    if (rank == MASTER) {
+        all_results = checked_alloc(ctx.count * ENSEMBLE_FIELDS, sizeof(unsigned long long));
+    }
+    for (long b = 0; b < ctx.count; b += ENSEMBLE_CHUNK) {
+        long n = ctx.count - b < ENSEMBLE_CHUNK ? ctx.count - b : ENSEMBLE_CHUNK;
+        MPI_Reduce(ctx.results + b * ENSEMBLE_FIELDS, rank == MASTER ? all_results + b * ENSEMBLE_FIELDS : NULL,
+                   (int)(n * ENSEMBLE_FIELDS), MPI_UNSIGNED_LONG_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD);
+    }
+
+    if (rank == MASTER) {
+        FILE *out = opt->ensemble_out != NULL ? fopen(opt->ensemble_out, "w") : stdout;
+        char rule[32];
+        if (out == NULL) {
+            printf("Error, cannot open %s.\n", opt->ensemble_out);
+            out = stdout;
+        }
+        fprintf(out, "# board rows cols rule seed generations live status hash\n");
+        for (long b = 0; b < ctx.count; b++) {
+            unsigned long long *res = all_results + b * ENSEMBLE_FIELDS;
+            long long status = (long long)res[2];
+            format_rule(ctx.jobs[b].rule, rule);
+            fprintf(out, "%ld %d %d %s %llu %llu %llu ", b, ctx.jobs[b].rows, ctx.jobs[b].cols, rule,
+                    (unsigned long long)ctx.jobs[b].seed, res[0], res[1]);
+            if (status == CYCLE_EXTINCTION) {
+                fprintf(out, "extinct");
+            } else if (status == CYCLE_NONE) {
+                fprintf(out, "running");
+            } else {
+                fprintf(out, "period-%lld", status);
+            }
+            fprintf(out, " %016llx\n", res[3]);
+        }
+        if (out != stdout) {
+            fclose(out);
+        }
+        printf("\nExecution Time: %f ms\n", MPI_Wtime() - start_time);
+        free(all_results);
+    }
+    free(ctx.results);
+    free(ctx.jobs);
+    free(ctx.order);
+    free(ctx.groups);
+}
@@ -0,0 +1,619 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Scambio delle righe di bordo: backend ring, rma, shm e compact e avanzamento delle comunicazioni
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "gol_engine.h"
+
+/*
+* @brief Indice del buffer di generazione a cui appartiene un puntatore
+*/
+static int buffer_index(halo_exchange *halo, char *buffer) {
+    return buffer == halo->buffers[0] ? 0 : 1;
+}
+
+/*
+* @brief Prende dall'arena i due buffer di generazione, ognuno con depth righe fantasma per lato
+* 
+* @param halo scambio da preparare
+* @param arena arena del processo
+* @return true
+*/
+static bool ring_open(halo_exchange *halo, grid_arena *arena) {
+    size_t slab_bytes = ((size_t)halo->rows + 2 * halo->depth) * halo->cols;
+    for (int b = 0; b < 2; b++) {
+        halo->buffers[b] = arena_take(arena, slab_bytes) + (size_t)halo->depth * halo->cols;
+    }
+    return true;
+}
+
+/*
+* @brief Avvia in modalità non bloccante lo scambio delle righe di bordo di una porzione
+* 
+* Le righe dei vicini vengono ricevute direttamente nelle righe fantasma della porzione,
+* depth righe per lato. Le quattro request vengono completate da ring_finish: le ricezioni
+* prima di leggere le righe fantasma, gli invii prima di sovrascrivere le righe di bordo.
+*
+* @param halo scambio da avviare
+* @param buffer prima riga posseduta della porzione
+*/
+static void ring_start(halo_exchange *halo, char *buffer) {
+    long long col_size = halo->cols;
+    int rows = halo->rows, depth = halo->depth;
+    halo->current = buffer_index(halo, buffer);
+    /* rank riceve le righe precedenti dal suo predecessore nelle righe fantasma superiori */
+    MPI_Irecv(buffer - (size_t)col_size * depth, depth, halo->row_data, halo->prev_rank, TAG_NEXT, halo->comm, &halo->requests[0]);
+    /* rank riceve le righe successive dal suo successore nelle righe fantasma inferiori */
+    MPI_Irecv(buffer + (size_t)col_size * rows, depth, halo->row_data, halo->next_rank, TAG_PREV, halo->comm, &halo->requests[1]);
+    /* rank invia le sue prime righe al processo precedente */
+    MPI_Isend(buffer, depth, halo->row_data, halo->prev_rank, TAG_PREV, halo->comm, &halo->requests[2]);
+    /* rank invia le sue ultime righe al suo successore */
+    MPI_Isend(buffer + (size_t)col_size * (rows - depth), depth, halo->row_data, halo->next_rank, TAG_NEXT, halo->comm, &halo->requests[3]);
+}
+
+/*
+* @brief Fa avanzare lo scambio con MPI_Testall
+* 
+* @param halo scambio in corso
+* @return true se tutte le request sono completate
+*/
+static bool ring_progress(halo_exchange *halo) {
+    int done;
+    MPI_Testall(4, halo->requests, &done, MPI_STATUSES_IGNORE);
+    return done;
+}
+
+/*
+* @brief Attende ricezioni e invii dello scambio in corso
+* 
+* @param halo scambio in corso
+*/
+static void ring_finish(halo_exchange *halo) {
+    MPI_Waitall(4, halo->requests, MPI_STATUSES_IGNORE);
+}
+
+/*
+* @brief Nessuna risorsa da liberare: i buffer appartengono all'arena
+*/
+static void ring_close(halo_exchange *halo) {
+    (void)halo;
+}
+
+/*
+* @brief Prende i buffer dall'arena e apre una finestra RMA su ognuno
+* 
+* La finestra comprende anche le righe fantasma: i vicini vi scrivono
+* direttamente con MPI_Put.
+* 
+* @param halo scambio da preparare
+* @param arena arena del processo
+* @return false con un solo processo, che non ha vicini a cui scrivere
+*/
+static bool rma_open(halo_exchange *halo, grid_arena *arena) {
+    size_t slab_bytes = ((size_t)halo->rows + 2 * halo->depth) * halo->cols;
+    if (halo->prev_rank == halo->next_rank && halo->next_rank == halo->rank) {
+        return false;
+    }
+    ring_open(halo, arena);
+    for (int b = 0; b < 2; b++) {
+        MPI_Win_create(halo->buffers[b] - (size_t)halo->depth * halo->cols, (MPI_Aint)slab_bytes, 1, MPI_INFO_NULL, halo->comm, &halo->windows[b]);
+    }
+    return true;
+}
+
+/*
+* @brief Apre un'epoca di accesso e scrive le righe di bordo nelle righe fantasma dei vicini
+* 
+* La fence iniziale garantisce che i vicini abbiano finito di leggere le righe fantasma
+* dell'ultima generazione ospitata da questo buffer, due generazioni prima.
+*
+* @param halo scambio da avviare
+* @param buffer prima riga posseduta della porzione
+*/
+static void rma_start(halo_exchange *halo, char *buffer) {
+    long long col_size = halo->cols;
+    int depth = halo->depth;
+    halo->current = buffer_index(halo, buffer);
+    MPI_Win win = halo->windows[halo->current];
+    MPI_Win_fence(MPI_MODE_NOPRECEDE, win);
+    /* le prime righe vanno nelle righe fantasma inferiori del precedente, dopo le sue righe possedute */
+    MPI_Put(buffer, depth, halo->row_data, halo->prev_rank, (MPI_Aint)(halo->prev_rows + depth) * col_size, depth, halo->row_data, win);
+    /* le ultime righe vanno nelle righe fantasma superiori del successivo, all'inizio della finestra */
+    MPI_Put(buffer + (size_t)col_size * (halo->rows - depth), depth, halo->row_data, halo->next_rank, 0, depth, halo->row_data, win);
+}
+
+/*
+* @brief Entra nella libreria MPI per far avanzare le scritture in corso
+* 
+* @param halo scambio in corso
+* @return false, lo scambio termina solo con la fence finale
+*/
+static bool rma_progress(halo_exchange *halo) {
+    int flag;
+    MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, halo->comm, &flag, MPI_STATUS_IGNORE);
+    return false;
+}
+
+/*
+* @brief Chiude l'epoca: le righe fantasma del buffer sono aggiornate
+* 
+* @param halo scambio in corso
+*/
+static void rma_finish(halo_exchange *halo) {
+    MPI_Win_fence(MPI_MODE_NOSUCCEED, halo->windows[halo->current]);
+}
+
+/*
+* @brief Libera le finestre RMA
+*/
+static void rma_close(halo_exchange *halo) {
+    for (int b = 0; b < 2; b++) {
+        MPI_Win_free(&halo->windows[b]);
+    }
+}
+
+/*
+* @brief Alloca i buffer in memoria condivisa fra i processi del nodo
+* 
+* Funziona solo se tutti i processi sono sullo stesso nodo, altrimenti il chiamante
+* usa il backend ring. I buffer non vengono presi dall'arena: ogni processo
+* conosce l'indirizzo delle righe di bordo dei vicini e le copia direttamente.
+* 
+* @param halo scambio da preparare
+* @param arena arena del processo, usata solo per escludere quella su file
+* @return false se i processi non condividono tutti la memoria o la porzione è su file
+*/
+static bool shm_open(halo_exchange *halo, grid_arena *arena) {
+    int rank, num_proc, node_size;
+    size_t ghost_bytes = (size_t)halo->depth * halo->cols;
+    size_t slab_bytes = ((size_t)halo->rows + 2 * halo->depth) * halo->cols;
+    /* i buffer in memoria condivisa non potrebbero stare nel file dell'arena */
+    if (arena->fd >= 0) {
+        return false;
+    }
+
+    MPI_Comm_rank(halo->comm, &rank);
+    MPI_Comm_size(halo->comm, &num_proc);
+    /* con la chiave pari al rank, l'ordine nel nodo coincide con quello dell'anello */
+    MPI_Comm_split_type(halo->comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &halo->node);
+    MPI_Comm_size(halo->node, &node_size);
+    if (node_size != num_proc) {
+        MPI_Comm_free(&halo->node);
+        return false;
+    }
+    for (int b = 0; b < 2; b++) {
+        char *base, *peer;
+        MPI_Aint size;
+        int disp_unit;
+        MPI_Win_allocate_shared((MPI_Aint)slab_bytes, 1, MPI_INFO_NULL, halo->node, &base, &halo->windows[b]);
+        halo->buffers[b] = base + ghost_bytes;
+        /* ultime righe possedute del precedente e prima riga posseduta del successivo */
+        MPI_Win_shared_query(halo->windows[b], halo->prev_rank, &size, &disp_unit, &peer);
+        halo->peer_prev[b] = peer + ghost_bytes + (size_t)(halo->prev_rows - halo->depth) * halo->cols;
+        MPI_Win_shared_query(halo->windows[b], halo->next_rank, &size, &disp_unit, &peer);
+        halo->peer_next[b] = peer + ghost_bytes;
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, halo->windows[b]);
+    }
+    return true;
+}
+
+/*
+* @brief Le righe di bordo sono già nel buffer condiviso: viene solo ricordato il buffer
+*/
+static void shm_start(halo_exchange *halo, char *buffer) {
+    halo->current = buffer_index(halo, buffer);
+}
+
+/*
+* @brief Attende che tutti abbiano calcolato le righe di bordo e copia quelle dei vicini
+* 
+* Dopo la barriera i vicini non possono riscrivere queste righe prima di aver superato
+* la barriera della generazione successiva, quindi la copia non ha conflitti.
+* 
+* @param halo scambio in corso
+*/
+static void shm_finish(halo_exchange *halo) {
+    int b = halo->current;
+    char *buffer = halo->buffers[b];
+    MPI_Win_sync(halo->windows[b]);
+    MPI_Barrier(halo->node);
+    MPI_Win_sync(halo->windows[b]);
+    size_t ghost_bytes = (size_t)halo->depth * halo->cols;
+    memcpy(buffer - ghost_bytes, halo->peer_prev[b], ghost_bytes);
+    memcpy(buffer + (size_t)halo->cols * halo->rows, halo->peer_next[b], ghost_bytes);
+}
+
+/*
+* @brief Libera la memoria condivisa e il communicator del nodo
+*/
+static void shm_close(halo_exchange *halo) {
+    for (int b = 0; b < 2; b++) {
+        MPI_Win_unlock_all(halo->windows[b]);
+        MPI_Win_free(&halo->windows[b]);
+    }
+    MPI_Comm_free(&halo->node);
+}
+
+/*
+* @brief Codifica una riga di bordo scegliendo la rappresentazione più corta
+* 
+* La codifica sparsa scrive il numero di celle vive e, per ognuna, la lunghezza
+* della sequenza di celle morte che la precede. Se supera la dimensione della
+* codifica densa, la riga viene scritta con un bit per cella.
+*
+* @param row riga da codificare
+* @param cols numero di colonne
+* @param out destinazione, di almeno size byte
+* @param size dimensione della codifica densa, byte iniziale compreso
+* @return numero di byte da inviare
+*/
+static int encode_row(const char *row, long long cols, unsigned char *out, size_t size) {
+    long long live = 0;
+    for (long long c = 0; c < cols; c++) {
+        live += row[c] == ALIVE;
+    }
+    /* ogni cella viva occupa almeno un byte */
+    if ((size_t)live < size - 1) {
+        size_t n = 1;
+        long long prev = -1;
+        unsigned char gap[10];
+        out[0] = HALO_SPARSE;
+        n += put_varint(out + n, live);
+        for (long long c = 0; c < cols && n <= size; c++) {
+            if (row[c] == ALIVE) {
+                size_t len = put_varint(gap, c - prev - 1);
+                if (n + len > size) {
+                    n = size + 1;
+                    break;
+                }
+                memcpy(out + n, gap, len);
+                n += len;
+                prev = c;
+            }
+        }
+        if (n <= size) {
+            return (int)n;
+        }
+    }
+    out[0] = HALO_DENSE;
+    memset(out + 1, 0, size - 1);
+    for (long long c = 0; c < cols; c++) {
+        if (row[c] == ALIVE) {
+            out[1 + c / 8] |= 1 << (c % 8);
+        }
+    }
+    return (int)size;
+}
+
+/*
+* @brief Decodifica una riga di bordo ricevuta in una riga fantasma
+* 
+* @param in riga codificata
+* @param row riga fantasma da scrivere
+* @param cols numero di colonne
+* @return inizio della riga codificata successiva nel messaggio
+*/
+static const unsigned char *decode_row(const unsigned char *in, char *row, long long cols) {
+    if (in[0] == HALO_DENSE) {
+        for (long long c = 0; c < cols; c++) {
+            row[c] = (in[1 + c / 8] >> (c % 8)) & 1 ? ALIVE : DEAD;
+        }
+        return in + 1 + (cols + 7) / 8;
+    }
+    const unsigned char *next = in + 1;
+    unsigned long long live = get_varint(&next);
+    long long c = -1;
+    memset(row, DEAD, cols);
+    for (unsigned long long i = 0; i < live; i++) {
+        c += (long long)get_varint(&next) + 1;
+        row[c] = ALIVE;
+    }
+    return next;
+}
+
+/*
+* @brief Prende i buffer dall'arena e alloca i quattro messaggi codificati
+* 
+* Un messaggio contiene depth righe codificate una dopo l'altra: la dimensione
+* massima è quella della codifica densa di tutte le righe. I messaggi hanno lunghezza
+* variabile e viaggiano come MPI_BYTE, quindi non possono superare INT_MAX byte.
+*
+* @param halo scambio da preparare
+* @param arena arena del processo
+* @return false se un messaggio di depth righe dense supera INT_MAX byte
+*/
+static bool compact_open(halo_exchange *halo, grid_arena *arena) {
+    long long packed_size = (long long)halo->depth * (1 + (halo->cols + 7) / 8);
+    if (packed_size > INT_MAX) {
+        return false;
+    }
+    ring_open(halo, arena);
+    halo->packed_size = (int)packed_size;
+    halo->packed[0] = checked_alloc(4, halo->packed_size);
+    for (int p = 1; p < 4; p++) {
+        halo->packed[p] = halo->packed[0] + (size_t)p * halo->packed_size;
+    }
+    return true;
+}
+
+/*
+* @brief Codifica le righe di bordo e avvia lo scambio come ring
+* 
+* Le righe codificate restano nei buffer di invio fino a compact_finish,
+* le righe ricevute vengono decodificate solo a scambio completato.
+*
+* @param halo scambio da avviare
+* @param buffer prima riga posseduta della porzione
+*/
+static void compact_start(halo_exchange *halo, char *buffer) {
+    long long col_size = halo->cols;
+    int size = halo->packed_size, depth = halo->depth;
+    int row_size = size / depth;
+    int first = 0, last = 0;
+    halo->current = buffer_index(halo, buffer);
+    MPI_Irecv(halo->packed[0], size, MPI_BYTE, halo->prev_rank, TAG_NEXT, halo->comm, &halo->requests[0]);
+    MPI_Irecv(halo->packed[1], size, MPI_BYTE, halo->next_rank, TAG_PREV, halo->comm, &halo->requests[1]);
+    for (int d = 0; d < depth; d++) {
+        unsigned char *out = halo->packed[2] + first;
+        first += encode_row(buffer + (size_t)col_size * d, col_size, out, row_size);
+        halo->messages[out[0]]++;
+    }
+    MPI_Isend(halo->packed[2], first, MPI_BYTE, halo->prev_rank, TAG_PREV, halo->comm, &halo->requests[2]);
+    for (int d = 0; d < depth; d++) {
+        unsigned char *out = halo->packed[3] + last;
+        last += encode_row(buffer + (size_t)col_size * (halo->rows - depth + d), col_size, out, row_size);
+        halo->messages[out[0]]++;
+    }
+    MPI_Isend(halo->packed[3], last, MPI_BYTE, halo->next_rank, TAG_NEXT, halo->comm, &halo->requests[3]);
+    halo->sent_bytes += first + last;
+}
+
+/*
+* @brief Attende lo scambio e decodifica le righe dei vicini nelle righe fantasma
+* 
+* @param halo scambio in corso
+*/
+static void compact_finish(halo_exchange *halo) {
+    char *buffer = halo->buffers[halo->current];
+    const unsigned char *prev = halo->packed[0], *next = halo->packed[1];
+    MPI_Waitall(4, halo->requests, MPI_STATUSES_IGNORE);
+    for (int d = 0; d < halo->depth; d++) {
+        prev = decode_row(prev, buffer + (size_t)halo->cols * (d - halo->depth), halo->cols);
+        next = decode_row(next, buffer + (size_t)halo->cols * (halo->rows + d), halo->cols);
+    }
+}
+
+/*
+* @brief Libera le righe codificate, i buffer appartengono all'arena
+*/
+static void compact_close(halo_exchange *halo) {
+    free(halo->packed[0]);
+}
+
+/* backend disponibili, il primo è quello di default */
+static const halo_backend backends[] = {
+    { "ring", true, ring_open, ring_start, ring_progress, ring_finish, ring_close },
+    { "rma", true, rma_open, rma_start, rma_progress, rma_finish, rma_close },
+    { "shm", false, shm_open, shm_start, NULL, shm_finish, shm_close },
+    { "compact", true, compact_open, compact_start, ring_progress, compact_finish, compact_close },
+};
+
+/*
+* @brief Cerca un backend di scambio per nome
+* 
+* @param name nome del backend, NULL per quello di default
+* @return backend trovato, NULL se il nome non è valido
+*/
+const halo_backend *find_halo(const char *name) {
+    if (name == NULL) {
+        return &backends[0];
+    }
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (strcmp(backends[b].name, name) == 0) {
+            return &backends[b];
+        }
+    }
+    return NULL;
+}
+
+/*
+* @brief Prepara lo scambio delle righe di bordo e i due buffer di generazione
+* 
+* @param halo scambio da preparare
+* @param backend backend da usare
+* @param arena arena da cui prendere i buffer
+* @param row_data datatype che indica una riga della matrice
+* @param rank rank del processo corrente
+* @param num_proc numero di processi
+* @param place posizione dei processi nell'anello, deve restare valida fino a halo_close
+* @param rows_for_proc righe assegnate ad ogni processo, almeno depth per processo
+* @param cols numero di colonne della matrice
+* @param depth righe fantasma per lato, pari al raggio del vicinato del kernel
+* @return false se il backend non è utilizzabile, lo stesso esito su tutti i processi
+*/
+bool halo_open(halo_exchange *halo, const halo_backend *backend, grid_arena *arena, MPI_Datatype row_data,
+               int rank, int num_proc, const ring_placement *place, int *rows_for_proc, long long cols, int depth) {
+    memset(halo, 0, sizeof(halo_exchange));
+    halo->backend = backend;
+    halo->row_data = row_data;
+    halo->rank = rank;
+    halo->place = place;
+    halo->comm = place->comm;
+    halo->rows = rows_for_proc[rank];
+    halo->cols = cols;
+    halo->depth = depth;
+    /* calcolo rank processi successivo e precedente al corrente nell'anello (tenendo conto del toroide) */
+    int pos = place->position[rank];
+    halo->prev_rank = place->order[(pos - 1 + num_proc) % num_proc];
+    halo->next_rank = place->order[(pos + 1) % num_proc];
+    halo->prev_rows = rows_for_proc[halo->prev_rank];
+    return backend->open(halo, arena);
+}
+
+/*
+* @brief Libera le risorse del backend di scambio
+* 
+* @param halo scambio da chiudere
+*/
+void halo_close(halo_exchange *halo) {
+    halo->backend->close(halo);
+}
+
+/*
+* @brief Corpo del thread di avanzamento
+* 
+* Molte implementazioni MPI fanno avanzare i trasferimenti non bloccanti solo
+* all'interno di una chiamata MPI: mentre il thread principale calcola le righe interne
+* questo thread chiama MPI_Iprobe su un communicator su cui non viene mai inviato nulla,
+* solo per entrare nel motore di avanzamento della libreria.
+*
+* @param arg halo_progress del processo
+* @return NULL
+*/
+static void *progress_thread(void *arg) {
+    halo_progress *prog = arg;
+    int flag;
+    pthread_mutex_lock(&prog->lock);
+    for (;;) {
+        while (!prog->active && !prog->closing) {
+            pthread_cond_wait(&prog->wake, &prog->lock);
+        }
+        if (prog->closing) {
+            break;
+        }
+        pthread_mutex_unlock(&prog->lock);
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, prog->comm, &flag, MPI_STATUS_IGNORE);
+        pthread_mutex_lock(&prog->lock);
+        prog->polls++;
+    }
+    pthread_mutex_unlock(&prog->lock);
+    return NULL;
+}
+
+/*
+* @brief Prepara l'avanzamento delle comunicazioni ed eventualmente avvia il thread
+* 
+* Il thread usa un duplicato del communicator dello scambio, che può essere diverso
+* da MPI_COMM_WORLD (anello riordinato o communicator della libreria).
+*
+* @param prog avanzamento da preparare
+* @param halo scambio delle righe di bordo, già aperto
+* @param mode una delle modalità PROGRESS_*
+* @param rows righe interne fra due chiamate di avanzamento
+*/
+void progress_open(halo_progress *prog, const halo_exchange *halo, int mode, int rows) {
+    memset(prog, 0, sizeof(halo_progress));
+    prog->mode = mode;
+    prog->rows = rows;
+    if (mode == PROGRESS_THREAD) {
+        MPI_Comm_dup(halo->comm, &prog->comm);
+        pthread_mutex_init(&prog->lock, NULL);
+        pthread_cond_init(&prog->wake, NULL);
+        pthread_create(&prog->thread, NULL, progress_thread, prog);
+    }
+}
+
+/*
+* @brief Calcola un blocco di righe interne, per bande se la porzione è su file
+* 
+* @param prog avanzamento delle comunicazioni, con l'eventuale calcolo per bande
+* @param kernel kernel di calcolo
+* @param origin_buff prima riga posseduta del buffer da cui prendere i dati
+* @param result_buffer prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param col_size colonne della matrice
+* @param first_row indice globale della prima riga posseduta, per le statistiche
+* @param stats statistiche da aggiornare, NULL se disabilitate
+*/
+static void interior_rows(halo_progress *prog, const gol_kernel *kernel, char *origin_buff, char *result_buffer,
+                          int first, int last, long long col_size, long long first_row, gen_stats *stats) {
+    if (prog->stream != NULL) {
+        stream_rows(prog->stream, kernel, first, last, first_row, stats);
+    } else {
+        compute_rows(kernel, origin_buff, result_buffer, first, last, col_size, first_row, stats);
+    }
+}
+
+/*
+* @brief Calcola le righe interne facendo avanzare lo scambio delle righe di bordo
+* 
+* @param prog avanzamento delle comunicazioni
+* @param halo scambio in corso, avviato sul buffer dei risultati
+* @param kernel kernel di calcolo
+* @param origin_buff prima riga posseduta del buffer da cui prendere i dati
+* @param result_buffer prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first_row indice globale della prima riga posseduta, per le statistiche
+* @param stats statistiche da aggiornare, NULL se disabilitate
+*/
+void progress_compute(halo_progress *prog, halo_exchange *halo, const gol_kernel *kernel, char *origin_buff,
+                      char *result_buffer, long long first_row, gen_stats *stats) {
+    /* le righe interne non sono inviate ai vicini: sono a più di depth righe dai bordi */
+    int first = halo->depth, end = halo->rows - halo->depth;
+    long long col_size = halo->cols;
+    double start = MPI_Wtime();
+    if (prog->stream != NULL) {
+        stream_begin(prog->stream, origin_buff, result_buffer, first, end);
+    }
+    if (prog->mode == PROGRESS_TEST) {
+        bool done = false;
+        for (int i = first; i < end; i += prog->rows) {
+            int last = (end - i > prog->rows) ? i + prog->rows : end;
+            interior_rows(prog, kernel, origin_buff, result_buffer, i, last, col_size, first_row, stats);
+            /* una volta completato lo scambio non serve più interrogare MPI */
+            if (!done) {
+                done = halo->backend->progress(halo);
+                prog->polls++;
+            }
+        }
+    } else if (prog->mode == PROGRESS_THREAD) {
+        pthread_mutex_lock(&prog->lock);
+        prog->active = true;
+        pthread_cond_signal(&prog->wake);
+        pthread_mutex_unlock(&prog->lock);
+
+        interior_rows(prog, kernel, origin_buff, result_buffer, first, end, col_size, first_row, stats);
+
+        pthread_mutex_lock(&prog->lock);
+        prog->active = false;
+        pthread_mutex_unlock(&prog->lock);
+    } else {
+        interior_rows(prog, kernel, origin_buff, result_buffer, first, end, col_size, first_row, stats);
+    }
+    prog->compute_time += MPI_Wtime() - start;
+}
+
+/*
+* @brief Completa lo scambio delle righe di bordo misurando l'attesa rimasta dopo il calcolo
+* 
+* @param prog avanzamento delle comunicazioni
+* @param halo scambio in corso
+*/
+void progress_wait(halo_progress *prog, halo_exchange *halo) {
+    double start = MPI_Wtime();
+    halo->backend->finish(halo);
+    prog->wait_time += MPI_Wtime() - start;
+}
+
+/*
+* @brief Termina il thread di avanzamento, se presente
+* 
+* @param prog avanzamento da chiudere
+*/
+void progress_close(halo_progress *prog) {
+    if (prog->mode != PROGRESS_THREAD) {
+        return;
+    }
+    pthread_mutex_lock(&prog->lock);
+    prog->closing = true;
+    pthread_cond_signal(&prog->wake);
+    pthread_mutex_unlock(&prog->lock);
+    pthread_join(prog->thread, NULL);
+    MPI_Comm_free(&prog->comm);
+    pthread_mutex_destroy(&prog->lock);
+    pthread_cond_destroy(&prog->wake);
+}
@@ -0,0 +1,315 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Storia registrata: accesso diretto a una generazione dai file delta e dai loro indici
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gol_engine.h"
+
+/*
+* @brief Mappa in sola lettura un intero file
+*
+* @param path file da mappare
+* @param size dimensione del file
+* @return inizio della mappatura, NULL se il file non esiste o è vuoto
+*/
+static const void *map_file(const char *path, size_t *size) {
+    struct stat info;
+    void *data = NULL;
+    int fd = open(path, O_RDONLY);
+    *size = 0;
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = NULL;
+        } else {
+            *size = info.st_size;
+        }
+    }
+    close(fd);
+    return data;
+}
+
+/*
+* @brief Legge un varint controllando di non superare la fine dei dati
+*
+* @param next posizione di lettura, avanzata oltre il varint
+* @param limit fine dei dati
+* @param value valore letto
+* @return false se il varint è troncato o più lungo di 64 bit
+*/
+static bool read_varint(const unsigned char **next, const unsigned char *limit, unsigned long long *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && *next < limit; shift += 7) {
+        unsigned char byte = *(*next)++;
+        *value |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+* @brief Confronta due porzioni per prima riga, per qsort
+*/
+static int compare_parts(const void *a, const void *b) {
+    const history_part *x = a, *y = b;
+    return (x->first_row > y->first_row) - (x->first_row < y->first_row);
+}
+
+/*
+* @brief Mappa il file delta di un processo e ne legge l'intestazione
+*
+* @param part porzione da riempire
+* @param path file delta
+* @param header processi, prima riga, righe, colonne, righe della matrice, keyframe
+* @return false se il file manca o l'intestazione non è valida
+*/
+static bool open_part(history_part *part, const char *path, unsigned long long header[6]) {
+    size_t magic = sizeof(DELTA_MAGIC) - 1;
+    part->data = map_file(path, &part->size);
+    if (part->data == NULL) {
+        return false;
+    }
+    const unsigned char *next = part->data + magic, *limit = part->data + part->size;
+    bool valid = part->size > magic && memcmp(part->data, DELTA_MAGIC, magic) == 0;
+    for (int h = 0; h < 6 && valid; h++) {
+        valid = read_varint(&next, limit, &header[h]);
+    }
+    if (!valid || header[0] < 1 || header[0] > INT_MAX || header[2] > INT_MAX || header[3] < 1 ||
+        header[4] > INT_MAX || header[5] > INT_MAX || header[1] + header[2] > header[4]) {
+        munmap((void *)part->data, part->size);
+        part->data = NULL;
+        return false;
+    }
+    part->first_row = (long long)header[1];
+    part->rows = (int)header[2];
+    return true;
+}
+
+/*
+* @brief Apre la storia registrata con --snapshot-format=delta
+*
+* L'intestazione di <prefisso>.r0 fissa il numero di processi, le dimensioni della
+* matrice e il periodo dei keyframe: vengono mappati solo i file da r0 a r<processi-1>,
+* quelli di rank superiori (resti di un'esecuzione con più processi) sono ignorati.
+* Ogni porzione deve riportare gli stessi valori e le porzioni, ordinate per prima
+* riga, devono coprire esattamente le righe della matrice, senza buchi né sovrapposizioni.
+*
+* @param store storia da aprire
+* @param prefix prefisso dei file di snapshot
+* @return false se i file mancano o non sono coerenti
+*/
+bool history_open(history_store *store, const char *prefix) {
+    char path[PATH_MAX];
+    unsigned long long first[6], header[6];
+    memset(store, 0, sizeof(history_store));
+    snprintf(path, sizeof(path), "%s.r0.delta", prefix);
+    history_part part;
+    if (!open_part(&part, path, first)) {
+        return false;
+    }
+    store->num_proc = (int)first[0];
+    store->cols = (long long)first[3];
+    store->row_size = (long long)first[4];
+    store->keyframe_every = (int)first[5];
+    store->parts = checked_alloc(store->num_proc, sizeof(history_part));
+    for (int p = 0; p < store->num_proc; p++) {
+        if (p > 0) {
+            snprintf(path, sizeof(path), "%s.r%d.delta", prefix, p);
+            if (!open_part(&part, path, header)) {
+                history_close(store);
+                return false;
+            }
+            if (header[0] != first[0] || header[3] != first[3] || header[4] != first[4] || header[5] != first[5]) {
+                munmap((void *)part.data, part.size);
+                history_close(store);
+                return false;
+            }
+        }
+        snprintf(path, sizeof(path), "%s.r%d.index", prefix, p);
+        part.entries = map_file(path, &part.index_size);
+        part.count = part.index_size / sizeof(delta_entry);
+        store->parts[store->part_count++] = part;
+    }
+
+    /* le porzioni seguono l'ordine di piazzamento, non quello dei rank */
+    history_part *sorted = checked_alloc(store->part_count, sizeof(history_part));
+    long long covered = 0;
+    memcpy(sorted, store->parts, store->part_count * sizeof(history_part));
+    qsort(sorted, store->part_count, sizeof(history_part), compare_parts);
+    for (int p = 0; p < store->part_count && covered >= 0; p++) {
+        covered = sorted[p].first_row == covered ? covered + sorted[p].rows : -1;
+    }
+    free(sorted);
+    if (covered != store->row_size) {
+        history_close(store);
+        return false;
+    }
+    return true;
+}
+
+/*
+* @brief Applica un record del file delta alle righe compresse della porzione
+*
+* @param part porzione della storia
+* @param offset posizione del record
+* @param packed righe compresse da aggiornare
+* @param size byte delle righe compresse
+* @return false se il record è troncato o non valido
+*/
+static bool apply_record(const history_part *part, long long offset, unsigned char *packed, size_t size) {
+    unsigned long long gen, len, skip, literal;
+    if (offset < 0 || (size_t)offset >= part->size) {
+        return false;
+    }
+    /* tipo, generazione e lunghezza del record, poi le coppie (invariati, modificati) */
+    const unsigned char *next = part->data + offset + 1, *limit = part->data + part->size;
+    if (!read_varint(&next, limit, &gen) || !read_varint(&next, limit, &len) || len > (size_t)(limit - next)) {
+        return false;
+    }
+    const unsigned char *end = next + len;
+    size_t pos = 0;
+    while (next < end) {
+        if (!read_varint(&next, end, &skip) || !read_varint(&next, end, &literal) ||
+            skip > size - pos || literal > size - pos - skip || literal > (size_t)(end - next)) {
+            return false;
+        }
+        pos += skip;
+        for (size_t k = 0; k < literal; k++) {
+            packed[pos + k] ^= next[k];
+        }
+        next += literal;
+        pos += literal;
+    }
+    return true;
+}
+
+/*
+* @brief Ricostruisce la matrice di una generazione registrata
+*
+* Per ogni porzione l'indice, ordinato per generazione, viene cercato in modo binario;
+* dal record trovato si torna al keyframe più vicino e si applicano solo i record da
+* quel keyframe in avanti, quindi il costo non dipende dalla lunghezza della storia.
+*
+* @param store storia aperta
+* @param gen generazione da ricostruire
+* @param board matrice di row_size * cols celle da riempire
+* @return false se la generazione non è registrata o i file sono danneggiati
+*/
+bool history_seek(history_store *store, int gen, char *board) {
+    size_t row_bytes = (store->cols + 7) / 8;
+    for (int p = 0; p < store->part_count; p++) {
+        const history_part *part = &store->parts[p];
+        long long lo = 0, hi = part->count;
+        while (lo < hi) {
+            long long mid = lo + (hi - lo) / 2;
+            if (part->entries[mid].gen < gen) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == part->count || part->entries[lo].gen != gen) {
+            return false;
+        }
+        long long key = lo;
+        while (key > 0 && (part->entries[key].offset >= (long long)part->size ||
+                           part->data[part->entries[key].offset] != DELTA_KEYFRAME)) {
+            key--;
+        }
+
+        size_t size = (size_t)part->rows * row_bytes;
+        unsigned char *packed = checked_alloc(size > 0 ? size : 1, 1);
+        bool ok = true;
+        memset(packed, 0, size);
+        for (long long e = key; e <= lo && ok; e++) {
+            ok = apply_record(part, part->entries[e].offset, packed, size);
+        }
+        for (int i = 0; i < part->rows && ok; i++) {
+            char *row = board + (size_t)(part->first_row + i) * store->cols;
+            const unsigned char *bits = packed + i * row_bytes;
+            for (long long j = 0; j < store->cols; j++) {
+                row[j] = (bits[j >> 3] & (0x80 >> (j & 7))) ? ALIVE : DEAD;
+            }
+        }
+        free(packed);
+        if (!ok) {
+            return false;
+        }
+        store->applied = (int)(lo - key + 1);
+    }
+    return true;
+}
+
+/*
+* @brief Libera le mappature della storia
+*
+* @param store storia da chiudere
+*/
+void history_close(history_store *store) {
+    for (int p = 0; p < store->part_count; p++) {
+        munmap((void *)store->parts[p].data, store->parts[p].size);
+        if (store->parts[p].entries != NULL) {
+            munmap((void *)store->parts[p].entries, store->parts[p].index_size);
+        }
+    }
+    free(store->parts);
+    store->parts = NULL;
+    store->part_count = 0;
+}
+
+/*
+* @brief Ricostruisce su MASTER una generazione registrata e la scrive in formato PBM
+*
+* Il file <prefisso>_<generazione>.pbm coincide con quello scritto da --snapshot-format=pbm
+* per la stessa generazione.
+*
+* @param opt opzioni da riga di comando: prefisso degli snapshot e generazione
+*/
+void run_seek(gol_options *opt) {
+    history_store store;
+    char path[PATH_MAX];
+    if (!history_open(&store, opt->snapshot_prefix)) {
+        printf("Error, cannot open history %s.r*.delta.\n", opt->snapshot_prefix);
+        return;
+    }
+    double start = MPI_Wtime();
+    char *board = checked_alloc(store.row_size, store.cols);
+    if (!history_seek(&store, opt->seek, board)) {
+        printf("Error, generation %d not recorded in %s.\n", opt->seek, opt->snapshot_prefix);
+        free(board);
+        history_close(&store);
+        return;
+    }
+    double elapsed = MPI_Wtime() - start;
+
+    size_t row_bytes = (store.cols + 7) / 8;
+    unsigned char *packed = checked_alloc(store.row_size, row_bytes);
+    pack_rows(board, (int)store.row_size, store.cols, packed);
+    snprintf(path, sizeof(path), "%s_%06d.pbm", opt->snapshot_prefix, opt->seek);
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        printf("Error, cannot open %s.\n", path);
+    } else {
+        fprintf(out, "P4\n%lld %lld\n", store.cols, store.row_size);
+        fwrite(packed, row_bytes, store.row_size, out);
+        fclose(out);
+        printf("History: generation %d rebuilt from %d records per process in %f s, written to %s\n",
+               opt->seek, store.applied, elapsed, path);
+    }
+    free(packed);
+    free(board);
+    history_close(&store);
+}
@@ -0,0 +1,403 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Kernel di calcolo di una generazione: scalare, vettorizzabile, a tabella e bit-packed
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "gol_engine.h"
+
+/*
+ * @brief Decide lo stato della cella per la generazione successiva
+ *  
+ * Controlla le 3 casistiche:
+ * una cellula viva con 2 o 3 vicini sopravvive per la prossima generazione
+ * se è morta e ha 3 vicini vivi torna in vita nella prossima generazione
+ * altrimenti in tutti i restanti casi muore.
+ * 
+ * @param origin buffer con valori pre-computazione
+ * @param result buffer in cui memorizzare i valori post computazione
+ * @param index indice della cella target
+ * @param live_count vicini vivi nell'intorno della cella target
+ */
+static void life(const char *origin, char *result, size_t index, int live_count) {
+    if (origin[index] == ALIVE && (live_count == 2 || live_count == 3)) {
+        result[index] = ALIVE;        
+    } else if (origin[index] == DEAD && live_count == 3) {
+        result[index] = ALIVE; 
+    } else {
+        result[index] = DEAD; 
+    }           
+}
+
+/*
+* @brief Kernel scalare: conta i vicini e applica life() cella per cella
+* 
+* La porzione è preceduta e seguita da una riga fantasma in cui vengono ricevute
+* le righe di bordo dei processi vicini, quindi le righe i-1 e i+1 sono sempre
+* accessibili e ogni riga viene calcolata allo stesso modo.
+*
+* @param kernel kernel di calcolo, con la sua regola
+* @param origin_buff prima riga posseduta del buffer da cui prendere i dati
+* @param result_buffer prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param col_size numero di colonne della matrice
+*/
+static void compute_scalar(const gol_kernel *kernel, const char *origin_buff, char *result_buffer, int first, int last,
+                           long long col_size) {
+    (void)kernel;
+    for (int i = first; i < last; i++) {
+        /* righe sopra, corrente e sotto: per i = 0 e per l'ultima riga si leggono le righe fantasma */
+        const char *row = origin_buff + (long long)i * col_size;
+        const char *above = row - col_size;
+        const char *below = row + col_size;
+
+        for (long long j = 0; j < col_size; j++) {
+            /* colonne vicine tenendo conto del toroide */
+            long long left = (j == 0) ? col_size - 1 : j - 1;
+            long long right = (j == col_size - 1) ? 0 : j + 1;
+
+            /* memorizza i vicini vivi nell'intorno della cella target (i,j) */
+            int live_count = (above[left] == ALIVE) + (above[j] == ALIVE) + (above[right] == ALIVE)
+                           + (row[left] == ALIVE) + (row[right] == ALIVE)
+                           + (below[left] == ALIVE) + (below[j] == ALIVE) + (below[right] == ALIVE);
+
+            /* decide lo stato della cella per la generazione successiva */
+            life(origin_buff, result_buffer, (size_t)i * col_size + j, live_count);
+        }
+    }
+}
+
+/*
+* @brief Kernel vettorizzabile: ciclo interno senza salti né modulo
+* 
+* Le due colonne di bordo, che si avvolgono sul toroide, sono calcolate dal kernel scalare.
+* Le colonne interne usano solo aritmetica su byte e una selezione finale,
+* così il compilatore può calcolare molte celle per istruzione.
+*
+* @param kernel kernel di calcolo, con la sua regola
+* @param origin_buff prima riga posseduta del buffer da cui prendere i dati
+* @param result_buffer prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param col_size numero di colonne della matrice
+*/
+static void compute_simd(const gol_kernel *kernel, const char *origin_buff, char *result_buffer, int first, int last,
+                         long long col_size) {
+    if (col_size < 3) {
+        compute_scalar(kernel, origin_buff, result_buffer, first, last, col_size);
+        return;
+    }
+    for (int i = first; i < last; i++) {
+        const char *restrict row = origin_buff + (long long)i * col_size;
+        const char *restrict above = row - col_size;
+        const char *restrict below = row + col_size;
+        char *restrict out = result_buffer + (long long)i * col_size;
+
+        for (long long j = 1; j < col_size - 1; j++) {
+            unsigned char live_count = (unsigned char)((above[j - 1] == ALIVE) + (above[j] == ALIVE) + (above[j + 1] == ALIVE)
+                                     + (row[j - 1] == ALIVE) + (row[j + 1] == ALIVE)
+                                     + (below[j - 1] == ALIVE) + (below[j] == ALIVE) + (below[j + 1] == ALIVE));
+            out[j] = (live_count == 3 || (live_count == 2 && row[j] == ALIVE)) ? ALIVE : DEAD;
+        }
+    }
+    /* colonne di bordo */
+    for (int i = first; i < last; i++) {
+        const char *row = origin_buff + (long long)i * col_size;
+        const char *above = row - col_size;
+        const char *below = row + col_size;
+        char *out = result_buffer + (long long)i * col_size;
+        long long edges[2] = { 0, col_size - 1 };
+        for (int e = 0; e < 2; e++) {
+            long long j = edges[e];
+            long long left = (j == 0) ? col_size - 1 : j - 1;
+            long long right = (j == col_size - 1) ? 0 : j + 1;
+            int live_count = (above[left] == ALIVE) + (above[j] == ALIVE) + (above[right] == ALIVE)
+                           + (row[left] == ALIVE) + (row[right] == ALIVE)
+                           + (below[left] == ALIVE) + (below[j] == ALIVE) + (below[right] == ALIVE);
+            out[j] = (live_count == 3 || (live_count == 2 && row[j] == ALIVE)) ? ALIVE : DEAD;
+        }
+    }
+}
+
+/*
+* @brief Riempie la tabella del kernel lut applicando la regola ad ogni intorno possibile
+*
+* L'indice contiene le 3 colonne dell'intorno 3x3, 3 bit per colonna (sinistra nei bit 6-8,
+* centro nei bit 3-5, destra nei bit 0-2; in ogni colonna sopra, cella, sotto).
+*
+* @param rule regola B/S
+* @param table tabella di 512 stati da riempire
+*/
+static void fill_life_table(const life_rule *rule, char *table) {
+    for (int index = 0; index < 512; index++) {
+        bool alive = (index >> 4) & 1;
+        int live_count = __builtin_popcount(index) - alive;
+        table[index] = ((alive ? rule->survive : rule->birth) >> live_count) & 1 ? ALIVE : DEAD;
+    }
+}
+
+/*
+* @brief Kernel a tabella: l'intorno 3x3 scorre lungo la riga come indice a 9 bit
+* 
+* Ad ogni colonna entra solo la colonna di destra, le altre due sono già nell'indice:
+* lo stato successivo è letto dalla tabella senza contare i vicini. La tabella segue la
+* regola B/S del kernel e costa 512 celle, quindi viene ricostruita ad ogni chiamata.
+*
+* @param kernel kernel di calcolo, con la sua regola
+* @param origin_buff prima riga posseduta del buffer da cui prendere i dati
+* @param result_buffer prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param col_size numero di colonne della matrice
+*/
+static void compute_lut(const gol_kernel *kernel, const char *origin_buff, char *result_buffer, int first, int last,
+                        long long col_size) {
+    char life_table[512];
+    fill_life_table(&kernel->life, life_table);
+    for (int i = first; i < last; i++) {
+        const char *row = origin_buff + (long long)i * col_size;
+        const char *above = row - col_size;
+        const char *below = row + col_size;
+        char *out = result_buffer + (long long)i * col_size;
+
+/* bit di una colonna dell'intorno: sopra, cella, sotto */
+#define LUT_COLUMN(j) ((unsigned)(above[j] == ALIVE) | (unsigned)(row[j] == ALIVE) << 1 | (unsigned)(below[j] == ALIVE) << 2)
+        /* la colonna a sinistra della prima è l'ultima, tenendo conto del toroide */
+        unsigned index = LUT_COLUMN(col_size - 1) << 3 | LUT_COLUMN(0);
+        for (long long j = 0; j < col_size - 1; j++) {
+            index = ((index << 3) | LUT_COLUMN(j + 1)) & 0x1FF;
+            out[j] = life_table[index];
+        }
+        index = ((index << 3) | LUT_COLUMN(0)) & 0x1FF;
+        out[col_size - 1] = life_table[index];
+#undef LUT_COLUMN
+    }
+}
+
+/*
+* @brief Impacchetta una riga in bit, con le colonne del toroide ai due estremi
+* 
+* Il bit 0 contiene l'ultima colonna, i bit da 1 a cols la riga e il bit cols + 1 la prima colonna,
+* così ogni cella ha i vicini di sinistra e destra nei bit adiacenti.
+*
+* @param row riga da impacchettare
+* @param cols numero di colonne della matrice
+* @param words parole a 64 bit in cui memorizzare la riga, con una parola di margine
+* @param count numero di parole
+*/
+static void pack_row(const char *row, long long cols, uint64_t *words, size_t count) {
+    memset(words, 0, count * sizeof(uint64_t));
+    for (long long j = 0; j < cols; j++) {
+        words[(j + 1) >> 6] |= (uint64_t)(row[j] == ALIVE) << ((j + 1) & 63);
+    }
+    words[0] |= (uint64_t)(row[cols - 1] == ALIVE);
+    words[(cols + 1) >> 6] |= (uint64_t)(row[0] == ALIVE) << ((cols + 1) & 63);
+}
+
+/*
+* @brief Legge 64 bit consecutivi a partire da un bit qualsiasi di una riga impacchettata
+*/
+static inline uint64_t packed_bits(const uint64_t *words, long long bit) {
+    int shift = bit & 63;
+    uint64_t low = words[bit >> 6] >> shift;
+    return shift == 0 ? low : low | words[(bit >> 6) + 1] << (64 - shift);
+}
+
+/*
+* @brief Kernel bit-packed: 64 celle per operazione con un sommatore bit a bit
+* 
+* Le tre righe dell'intorno vengono impacchettate a 64 celle per parola, gli 8 vicini
+* vengono sommati con un contatore a 3 bit calcolato in parallelo su tutte le celle
+* della parola e il risultato viene espanso di nuovo in caratteri.
+* Ogni riga viene impacchettata una sola volta e riusata per le tre righe che la leggono.
+* Le tre righe impacchettate stanno nella memoria di lavoro del kernel, allocata alla
+* prima chiamata e di nuovo solo se cambia il numero di colonne.
+*
+* @param kernel kernel di calcolo, con la sua regola
+* @param origin_buff prima riga posseduta del buffer da cui prendere i dati
+* @param result_buffer prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param col_size numero di colonne della matrice
+*/
+static void compute_packed(const gol_kernel *kernel, const char *origin_buff, char *result_buffer, int first, int last,
+                           long long col_size) {
+    kernel_scratch *scratch = kernel->scratch;
+    size_t count = (size_t)((col_size + 2 + 63) >> 6) + 1;
+
+    if (first >= last) {
+        return;
+    }
+    if (scratch->word_count != count) {
+        free(scratch->words);
+        scratch->words = checked_alloc(3 * count, sizeof(uint64_t));
+        scratch->word_count = count;
+    }
+    uint64_t *packed[3] = { scratch->words, scratch->words + count, scratch->words + 2 * count }, *temp;
+    pack_row(origin_buff + (long long)(first - 1) * col_size, col_size, packed[0], count);
+    pack_row(origin_buff + (long long)first * col_size, col_size, packed[1], count);
+    for (int i = first; i < last; i++) {
+        const char *row = origin_buff + (long long)i * col_size;
+        char *out = result_buffer + (long long)i * col_size;
+        pack_row(row + col_size, col_size, packed[2], count);
+
+        for (long long base = 0; base < col_size; base += 64) {
+            /* gli 8 vicini delle celle da base a base + 63 */
+            uint64_t neighbours[8] = {
+                packed_bits(packed[0], base), packed_bits(packed[0], base + 1), packed_bits(packed[0], base + 2),
+                packed_bits(packed[1], base), packed_bits(packed[1], base + 2),
+                packed_bits(packed[2], base), packed_bits(packed[2], base + 1), packed_bits(packed[2], base + 2)
+            };
+            uint64_t alive = packed_bits(packed[1], base + 1);
+            /* contatore a 3 bit dei vicini vivi, modulo 8: con 8 vicini la cella muore comunque */
+            uint64_t s0 = 0, s1 = 0, s2 = 0;
+            for (int n = 0; n < 8; n++) {
+                uint64_t carry0 = s0 & neighbours[n];
+                s0 ^= neighbours[n];
+                uint64_t carry1 = s1 & carry0;
+                s1 ^= carry0;
+                s2 ^= carry1;
+            }
+            /* 3 vicini, oppure 2 vicini e cella viva */
+            uint64_t next = s1 & ~s2 & (s0 | alive);
+            long long end = (col_size - base < 64) ? col_size - base : 64;
+            for (long long b = 0; b < end; b++) {
+                out[base + b] = ((next >> b) & 1) ? ALIVE : DEAD;
+            }
+        }
+        temp = packed[0];
+        packed[0] = packed[1];
+        packed[1] = packed[2];
+        packed[2] = temp;
+    }
+}
+
+/* kernel disponibili, il primo è quello di default */
+static const gol_kernel kernels[] = {
+    { "scalar", compute_scalar, CONWAY_RULE, CONWAY_LTL, NULL },
+    { "simd", compute_simd, CONWAY_RULE, CONWAY_LTL, NULL },
+    { "lut", compute_lut, CONWAY_RULE, CONWAY_LTL, NULL },
+    { "packed", compute_packed, CONWAY_RULE, CONWAY_LTL, NULL },
+    { "ltl", compute_ltl, CONWAY_RULE, CONWAY_LTL, NULL },
+};
+
+/*
+* @brief Cerca un kernel per nome
+* 
+* @param name nome del kernel, NULL per quello di default
+* @return kernel trovato, NULL se il nome non è valido
+*/
+const gol_kernel *find_kernel(const char *name) {
+    if (name == NULL) {
+        return &kernels[0];
+    }
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (strcmp(kernels[k].name, name) == 0) {
+            return &kernels[k];
+        }
+    }
+    return NULL;
+}
+
+/*
+* @brief Copia un kernel assegnandogli una regola Larger than Life
+*
+* Il kernel copiato appartiene al chiamante, quindi kernel ltl con regole e raggi
+* diversi possono convivere nello stesso processo. Ogni copia ha la propria memoria
+* di lavoro, da liberare con unbind_kernel prima di legarla di nuovo.
+*
+* @param kernel kernel da riempire
+* @param name nome del kernel, NULL per quello di default
+* @param rule regola del kernel ltl, NULL per B3/S23; gli altri kernel non la usano
+* @return false se il nome non è valido
+*/
+bool bind_kernel(gol_kernel *kernel, const char *name, const ltl_rule *rule) {
+    const gol_kernel *found = find_kernel(name);
+    if (found == NULL) {
+        return false;
+    }
+    *kernel = *found;
+    if (rule != NULL && strcmp(kernel->name, "ltl") == 0) {
+        kernel->ltl = *rule;
+    }
+    kernel->scratch = checked_alloc(1, sizeof(kernel_scratch));
+    memset(kernel->scratch, 0, sizeof(kernel_scratch));
+    return true;
+}
+
+/*
+* @brief Libera la memoria di lavoro di un kernel legato con bind_kernel
+*
+* @param kernel kernel da liberare, anche mai legato se azzerato
+*/
+void unbind_kernel(gol_kernel *kernel) {
+    if (kernel->scratch != NULL) {
+        free(kernel->scratch->sums);
+        free(kernel->scratch->words);
+        free(kernel->scratch);
+        kernel->scratch = NULL;
+    }
+}
+
+/*
+ * @brief Legge una regola in notazione B/S (ad esempio B3/S23)
+ * 
+ * @param text regola da leggere
+ * @param rule regola da riempire
+ * @return true se la regola è valida
+ */
+bool parse_rule(const char *text, life_rule *rule) {
+    uint16_t *target = NULL;
+    rule->birth = rule->survive = 0;
+    for (const char *c = text; *c != '\0'; c++) {
+        if (toupper(*c) == 'B') {
+            target = &rule->birth;
+        } else if (toupper(*c) == 'S') {
+            target = &rule->survive;
+        } else if (*c >= '0' && *c <= '8' && target != NULL) {
+            *target |= 1 << (*c - '0');
+        } else if (*c != '/') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+* @brief Raggio del vicinato del kernel, pari alle righe fantasma necessarie per lato
+* 
+* @param kernel kernel di calcolo
+* @return raggio del vicinato, 1 per i kernel di raggio 1
+*/
+int kernel_radius(const gol_kernel *kernel) {
+    return kernel->ltl.radius;
+}
+
+/*
+* @brief Calcola un intervallo di righe della nuova generazione e ne aggiorna le statistiche
+*
+* @param kernel kernel di calcolo
+* @param origin prima riga posseduta del buffer da cui prendere i dati
+* @param result prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param cols numero di colonne della matrice
+* @param first_row indice globale della prima riga posseduta, per le statistiche
+* @param stats statistiche da aggiornare, NULL se disabilitate
+*/
+void compute_rows(const gol_kernel *kernel, char *origin, char *result, int first, int last,
+                  long long cols, long long first_row, gen_stats *stats) {
+    if (first >= last) {
+        return;
+    }
+    kernel->compute(kernel, origin, result, first, last, cols);
+    if (stats != NULL) {
+        for (int i = first; i < last; i++) {
+            row_stats(origin + (long long)i * cols, result + (long long)i * cols, cols, first_row + i, stats);
+        }
+    }
+}
@@ -0,0 +1,218 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Libreria: creazione, avanzamento e accesso diretto alla porzione di una simulazione
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "gol.h"
+#include "gol_engine.h"
+
+#if GOL_ALIVE != ALIVE || GOL_DEAD != DEAD
+#error "gol.h e gol_engine.h devono usare gli stessi valori delle celle"
+#endif
+
+/* simulazione: lo stesso motore del programma principale, senza opzioni né output */
+struct gol_sim {
+    MPI_Comm comm;              /* duplicato del communicator indicato, riservato alla simulazione */
+    int rank, num_proc;
+    long long rows, cols;       /* dimensioni della matrice */
+    gol_kernel kernel;          /* kernel di calcolo, con la regola della simulazione */
+    int radius;                 /* raggio del vicinato del kernel, righe fantasma per lato */
+    int *rows_for_proc, *displ_for_proc;
+    MPI_Datatype row_data;      /* datatype che indica una riga della matrice */
+    ring_placement place;       /* posizione dei processi nell'anello */
+    grid_arena arena;           /* regione che contiene i due buffer di generazione */
+    halo_exchange halo;         /* scambio delle righe di bordo */
+    halo_progress progress;     /* calcolo delle righe interne, senza avanzamento dedicato */
+    char *current, *next;       /* prima riga posseduta della generazione corrente e della successiva */
+    long long generation;       /* generazione corrente */
+};
+
+/*
+* @brief Crea una simulazione con tutte le celle morte
+*
+* Operazione collettiva su comm, con gli stessi argomenti su tutti i processi. Le righe
+* vengono divise fra i processi come nel programma principale e scambiate con il backend
+* ring, su un duplicato di comm. La regola NULL o B3/S23 usa il kernel packed, le altre
+* regole B/S (ad esempio B36/S23) il kernel lut, le regole Larger than Life nella notazione
+* di --ltl il kernel ltl. La regola appartiene alla simulazione, quindi simulazioni con
+* regole diverse possono convivere nello stesso processo.
+*
+* @param comm communicator dei processi che dividono la matrice
+* @param rows righe della matrice, almeno una per processo per ogni unità di raggio
+* @param cols colonne della matrice
+* @param rule regola della simulazione in notazione B/S o Larger than Life, NULL per B3/S23
+* @return simulazione creata, NULL su tutti i processi se dimensioni o regola non sono valide
+*/
+gol_sim *gol_create(MPI_Comm comm, long long rows, long long cols, const char *rule) {
+    gol_kernel kernel;
+    life_rule life, conway = CONWAY_RULE;
+    ltl_rule ltl;
+    int num_proc;
+
+    if (rule == NULL) {
+        bind_kernel(&kernel, "packed", NULL);
+    } else if (parse_rule(rule, &life)) {
+        /* il kernel packed calcola solo B3/S23, la tabella del kernel lut qualsiasi regola B/S */
+        bool is_conway = life.birth == conway.birth && life.survive == conway.survive;
+        bind_kernel(&kernel, is_conway ? "packed" : "lut", NULL);
+        kernel.life = life;
+    } else if (parse_ltl(rule, &ltl)) {
+        bind_kernel(&kernel, "ltl", &ltl);
+    } else {
+        return NULL;
+    }
+    MPI_Comm_size(comm, &num_proc);
+    int radius = kernel_radius(&kernel);
+    if (rows < (long long)num_proc * radius || rows > INT_MAX || cols < 1 || cols > LLONG_MAX / rows) {
+        unbind_kernel(&kernel);
+        return NULL;
+    }
+
+    gol_sim *sim = checked_alloc(1, sizeof(gol_sim));
+    MPI_Comm_dup(comm, &sim->comm);
+    MPI_Comm_rank(sim->comm, &sim->rank);
+    sim->num_proc = num_proc;
+    sim->rows = rows;
+    sim->cols = cols;
+    sim->kernel = kernel;
+    sim->radius = radius;
+
+    make_row_type(cols, &sim->row_data);
+    sim->rows_for_proc = checked_alloc(num_proc, sizeof(int));
+    sim->displ_for_proc = checked_alloc(num_proc, sizeof(int));
+    placement_open(&sim->place, sim->comm, false);
+    split_rows(rows, num_proc, sim->place.order, sim->rows_for_proc, sim->displ_for_proc);
+
+    size_t slab_bytes = ((size_t)sim->rows_for_proc[sim->rank] + 2 * radius) * cols;
+    if (!arena_open(&sim->arena, 2 * (slab_bytes + ARENA_ALIGN), false)) {
+        fprintf(stderr, "Error, cannot map %zu bytes on rank %d.\n", 2 * slab_bytes, sim->rank);
+        MPI_Abort(comm, 1);
+    }
+    halo_open(&sim->halo, find_halo("ring"), &sim->arena, sim->row_data, sim->rank, num_proc, &sim->place,
+              sim->rows_for_proc, cols, radius);
+    progress_open(&sim->progress, &sim->halo, PROGRESS_NONE, DEF_PROGRESS_ROWS);
+    sim->current = sim->halo.buffers[0];
+    sim->next = sim->halo.buffers[1];
+    /* l'arena è azzerata, le celle morte vanno scritte anche nelle righe fantasma */
+    for (int b = 0; b < 2; b++) {
+        memset(sim->halo.buffers[b] - (size_t)radius * cols, DEAD, slab_bytes);
+    }
+    return sim;
+}
+
+/*
+* @brief Calcola le generazioni successive
+*
+* Operazione collettiva. Ogni generazione segue lo stesso schema del programma principale:
+* righe di bordo, avvio dello scambio, righe interne, attesa delle righe fantasma. La
+* porzione può essere stata modificata fra due chiamate con gol_set_region o tramite
+* gol_view_local_slab, anche solo su alcuni processi: le righe fantasma della generazione
+* corrente vengono quindi sempre riscambiate prima della prima generazione.
+*
+* @param sim simulazione
+* @param generations generazioni da calcolare
+*/
+void gol_step(gol_sim *sim, int generations) {
+    const halo_backend *backend = sim->halo.backend;
+    int rows = sim->rows_for_proc[sim->rank], radius = sim->radius;
+    long long first_row = sim->displ_for_proc[sim->rank];
+
+    if (generations > 0) {
+        backend->start(&sim->halo, sim->current);
+        backend->finish(&sim->halo);
+    }
+    for (int gen = 0; gen < generations; gen++) {
+        compute_rows(&sim->kernel, sim->current, sim->next, 0, radius, sim->cols, first_row, NULL);
+        if (rows > radius) {
+            compute_rows(&sim->kernel, sim->current, sim->next, rows - radius > radius ? rows - radius : radius, rows,
+                         sim->cols, first_row, NULL);
+        }
+        backend->start(&sim->halo, sim->next);
+        progress_compute(&sim->progress, &sim->halo, &sim->kernel, sim->current, sim->next, first_row, NULL);
+        progress_wait(&sim->progress, &sim->halo);
+
+        char *temp = sim->current;
+        sim->current = sim->next;
+        sim->next = temp;
+        sim->generation++;
+    }
+}
+
+/*
+* @brief Porzione posseduta dal processo, senza copie
+*
+* Il puntatore indica il buffer su cui lavora il motore ed è valido fino alla prossima
+* chiamata a gol_step, che scambia i due buffer. Le celle valgono GOL_ALIVE o GOL_DEAD e
+* possono essere modificate direttamente fino al gol_step successivo.
+*
+* @param sim simulazione
+* @return porzione della generazione corrente
+*/
+gol_slab gol_view_local_slab(gol_sim *sim) {
+    gol_slab slab = {
+        .cells = sim->current,
+        .first_row = sim->displ_for_proc[sim->rank],
+        .rows = sim->rows_for_proc[sim->rank],
+        .cols = sim->cols,
+        .stride = sim->cols,
+        .generation = sim->generation
+    };
+    return slab;
+}
+
+/*
+* @brief Scrive una regione della matrice nella generazione corrente
+*
+* Operazione locale: ogni processo copia solo l'intersezione della regione con le
+* proprie righe, quindi la stessa regione può essere passata a tutti i processi.
+* Le celle diverse da GOL_ALIVE vengono scritte come GOL_DEAD.
+*
+* @param sim simulazione
+* @param row riga globale del primo elemento della regione
+* @param col colonna del primo elemento della regione
+* @param rows righe della regione
+* @param cols colonne della regione
+* @param cells celle della regione, per righe
+* @param stride celle fra l'inizio di due righe consecutive di cells
+* @return 0, -1 se la regione esce dalla matrice
+*/
+int gol_set_region(gol_sim *sim, long long row, long long col, long long rows, long long cols,
+                   const char *cells, long long stride) {
+    if (row < 0 || col < 0 || rows < 0 || cols < 0 || row + rows > sim->rows || col + cols > sim->cols || stride < cols) {
+        return -1;
+    }
+    long long first = sim->displ_for_proc[sim->rank], last = first + sim->rows_for_proc[sim->rank];
+    long long lo = row > first ? row : first, hi = row + rows < last ? row + rows : last;
+    for (long long i = lo; i < hi; i++) {
+        const char *src = cells + (i - row) * stride;
+        char *dst = sim->current + (i - first) * sim->cols + col;
+        for (long long j = 0; j < cols; j++) {
+            dst[j] = src[j] == ALIVE ? ALIVE : DEAD;
+        }
+    }
+    return 0;
+}
+
+/*
+* @brief Libera la simulazione
+*
+* Operazione collettiva.
+*
+* @param sim simulazione da liberare
+*/
+void gol_destroy(gol_sim *sim) {
+    progress_close(&sim->progress);
+    halo_close(&sim->halo);
+    arena_close(&sim->arena);
+    placement_close(&sim->place);
+    unbind_kernel(&sim->kernel);
+    MPI_Type_free(&sim->row_data);
+    MPI_Comm_free(&sim->comm);
+    free(sim->rows_for_proc);
+    free(sim->displ_for_proc);
+    free(sim);
+}
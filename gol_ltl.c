@@ -0,0 +1,148 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Regole Larger than Life: vicinato di raggio fino a LTL_MAX_RADIUS con somme scorrevoli
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "gol_engine.h"
+
+/*
+* @brief Legge una regola Larger than Life nella notazione di Golly
+*
+* La regola ha la forma R5,C0,M1,S34..58,B34..45,NM: raggio, numero di stati
+* (0 o 2, solo due stati), cella centrale compresa nel conteggio, intervalli di
+* sopravvivenza e di nascita, vicinato di Moore. C, M e N sono facoltativi.
+*
+* @param spec regola da leggere
+* @param rule regola da riempire
+* @return true se la regola è valida
+*/
+bool parse_ltl(const char *spec, ltl_rule *rule) {
+    char buffer[128];
+    bool has_radius = false, has_birth = false, has_survive = false;
+    if (strlen(spec) >= sizeof(buffer)) {
+        return false;
+    }
+    strcpy(buffer, spec);
+    rule->middle = false;
+    for (char *token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+        int value, low, high;
+        char tail;
+        if (sscanf(token, "R%d%c", &value, &tail) == 1) {
+            rule->radius = value;
+            has_radius = true;
+        } else if (sscanf(token, "C%d%c", &value, &tail) == 1) {
+            if (value != 0 && value != 2) {
+                return false;
+            }
+        } else if (sscanf(token, "M%d%c", &value, &tail) == 1) {
+            if (value != 0 && value != 1) {
+                return false;
+            }
+            rule->middle = value == 1;
+        } else if (sscanf(token, "S%d..%d%c", &low, &high, &tail) == 2) {
+            rule->survive_min = low;
+            rule->survive_max = high;
+            has_survive = true;
+        } else if (sscanf(token, "B%d..%d%c", &low, &high, &tail) == 2) {
+            rule->birth_min = low;
+            rule->birth_max = high;
+            has_birth = true;
+        } else if (strcmp(token, "NM") != 0) {
+            return false;
+        }
+    }
+    if (!has_radius || !has_birth || !has_survive || rule->radius < 1 || rule->radius > LTL_MAX_RADIUS) {
+        return false;
+    }
+    int cells = (2 * rule->radius + 1) * (2 * rule->radius + 1);
+    return rule->birth_min >= 0 && rule->birth_min <= rule->birth_max && rule->birth_max <= cells &&
+           rule->survive_min >= 0 && rule->survive_min <= rule->survive_max && rule->survive_max <= cells;
+}
+
+/*
+* @brief Kernel Larger than Life: costo costante per cella per ogni raggio
+*
+* Per ogni colonna viene mantenuta la somma verticale delle 2r + 1 righe centrate
+* sulla riga corrente: passando alla riga successiva si aggiunge la riga che entra
+* e si toglie quella che esce. Lungo la riga, la finestra di 2r + 1 somme verticali
+* scorre allo stesso modo, avvolgendosi sul toroide. Le righe sopra e sotto la
+* porzione sono le righe fantasma, almeno r per lato.
+* Le somme restano nella memoria di lavoro del kernel: se la chiamata riprende dalla
+* riga in cui si è fermata la precedente sullo stesso buffer, come i blocchi consecutivi
+* di --progress e delle bande su file, le somme non vengono ricalcolate. Ogni
+* generazione comincia dalla riga 0, quindi le somme di un buffer riscritto non
+* vengono mai riprese.
+*
+* @param kernel kernel di calcolo, con la regola Larger than Life
+* @param origin_buff prima riga posseduta del buffer da cui prendere i dati
+* @param result_buffer prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param col_size numero di colonne della matrice
+*/
+void compute_ltl(const gol_kernel *kernel, const char *origin_buff, char *result_buffer, int first, int last,
+                 long long col_size) {
+    const ltl_rule *rule = &kernel->ltl;
+    kernel_scratch *scratch = kernel->scratch;
+    int r = rule->radius;
+
+    if (first >= last) {
+        return;
+    }
+    if (scratch->sums_cols != col_size) {
+        free(scratch->sums);
+        scratch->sums = checked_alloc(col_size, sizeof(int));
+        scratch->sums_cols = col_size;
+        scratch->sums_last = 0;
+    }
+    int *sums = scratch->sums;
+    bool resume = scratch->sums_origin == origin_buff && scratch->sums_last == first && first > 0;
+
+    /* somme verticali della prima riga da calcolare, se la chiamata precedente non le lascia pronte */
+    if (!resume) {
+        memset(sums, 0, col_size * sizeof(int));
+        for (int d = -r; d <= r; d++) {
+            const char *row = origin_buff + (long long)(first + d) * col_size;
+            for (long long j = 0; j < col_size; j++) {
+                sums[j] += row[j] == ALIVE;
+            }
+        }
+    }
+
+    for (int i = first; i < last; i++) {
+        const char *row = origin_buff + (long long)i * col_size;
+        char *out = result_buffer + (long long)i * col_size;
+        if (i > first || resume) {
+            const char *enter = origin_buff + (long long)(i + r) * col_size;
+            const char *leave = origin_buff + (long long)(i - r - 1) * col_size;
+            for (long long j = 0; j < col_size; j++) {
+                sums[j] += (enter[j] == ALIVE) - (leave[j] == ALIVE);
+            }
+        }
+
+        /* finestra delle colonne da -r a r attorno alla colonna 0, tenendo conto del toroide */
+        int window = 0;
+        for (int d = -r; d <= r; d++) {
+            window += sums[((d % col_size) + col_size) % col_size];
+        }
+        long long enter = (r + 1) % col_size, leave = ((-r % col_size) + col_size) % col_size;
+        for (long long j = 0; j < col_size; j++) {
+            bool alive = row[j] == ALIVE;
+            int count = window - (alive && !rule->middle);
+            if (alive) {
+                out[j] = (count >= rule->survive_min && count <= rule->survive_max) ? ALIVE : DEAD;
+            } else {
+                out[j] = (count >= rule->birth_min && count <= rule->birth_max) ? ALIVE : DEAD;
+            }
+            window += sums[enter] - sums[leave];
+            enter = (enter + 1 == col_size) ? 0 : enter + 1;
+            leave = (leave + 1 == col_size) ? 0 : leave + 1;
+        }
+    }
+    scratch->sums_origin = origin_buff;
+    scratch->sums_last = last;
+}
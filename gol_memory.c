@@ -0,0 +1,215 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Allocazione della memoria: allocazioni controllate, datatype di riga, divisione delle righe e arena dei buffer
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "gol_engine.h"
+
+/* 
+* @brief Alloca memoria controllando overflow e fallimenti
+* 
+* Le dimensioni della matrice sono a 64 bit: il prodotto count * size viene verificato
+* prima dell'allocazione e in caso di errore l'esecuzione termina su tutti i processi.
+* 
+* @param count numero di elementi
+* @param size dimensione di un elemento
+* @return memoria allocata (non inizializzata)
+*/
+void *checked_alloc(size_t count, size_t size) {
+    void *memory = NULL;
+    if (size == 0 || count <= SIZE_MAX / size) {
+        memory = malloc(count * size > 0 ? count * size : 1);
+    }
+    if (memory == NULL) {
+        fprintf(stderr, "Error, cannot allocate %zu x %zu bytes.\n", count, size);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return memory;
+}
+
+/* 
+* @brief Crea il datatype MPI di una riga della matrice
+* 
+* I conteggi MPI sono int: se la riga supera INT_MAX byte viene descritta
+* come blocchi da 2^30 byte seguiti dal resto, così ogni trasferimento
+* continua a contare righe intere.
+* 
+* @param cols numero di colonne della matrice
+* @param row_type indirizzo in cui memorizzare il datatype (già committato)
+*/
+void make_row_type(long long cols, MPI_Datatype *row_type) {
+    if (cols <= INT_MAX) {
+        MPI_Type_contiguous((int)cols, MPI_CHAR, row_type);
+    } else {
+        const long long chunk = 1LL << 30;
+        MPI_Datatype chunk_type, parts_type;
+        MPI_Type_contiguous((int)chunk, MPI_CHAR, &chunk_type);
+        MPI_Type_contiguous((int)(cols / chunk), chunk_type, &parts_type);
+        int lengths[2] = { 1, (int)(cols % chunk) };
+        MPI_Aint displs[2] = { 0, (MPI_Aint)(cols / chunk * chunk) };
+        MPI_Datatype types[2] = { parts_type, MPI_CHAR };
+        MPI_Type_create_struct(2, lengths, displs, types, row_type);
+        MPI_Type_free(&chunk_type);
+        MPI_Type_free(&parts_type);
+    }
+    MPI_Type_commit(row_type);
+}
+
+/* 
+* @brief Divide le righe della matrice fra i processi
+* 
+* Ogni processo riceve row_size/num_proc righe, i primi row_size%num_proc
+* processi ne ricevono una in più. Le porzioni sono assegnate nell'ordine
+* dell'anello: la posizione i riceve le righe successive a quelle della
+* posizione i - 1.
+* 
+* @param row_size righe della matrice
+* @param num_proc numero di processi
+* @param order rank in ogni posizione dell'anello
+* @param rows_for_proc righe assegnate ad ogni processo
+* @param displ_for_proc indice della prima riga di ogni processo
+*/
+void split_rows(long long row_size, int num_proc, const int *order, int *rows_for_proc, int *displ_for_proc) {
+    int base = (int)(row_size / num_proc);
+    int rest = (int)(row_size % num_proc);
+    /* righe già assegnate */
+    int assigned = 0;
+
+    /* calcolo righe e displacement per ogni processo */
+    for (int i = 0; i < num_proc; i++) {
+        int proc = order[i];
+        displ_for_proc[proc] = assigned;
+        /* nel caso di resto presente, i primi resto processi ricevono una riga in più*/
+        if (rest > 0) {
+            rows_for_proc[proc] = base + 1;
+            rest--;
+        } else {
+            rows_for_proc[proc] = base;
+        }
+        assigned += rows_for_proc[proc];
+    }
+}
+
+/* 
+* @brief Prepara l'arena di un processo: un'unica regione per entrambe le generazioni e le righe di bordo
+* 
+* La regione viene mappata con mmap anonima: le pagine vengono azzerate dal kernel
+* solo al primo accesso, quindi non c'è un azzeramento esplicito come con calloc.
+* Con huge_pages si tenta prima MAP_HUGETLB e, se non ci sono huge page riservate,
+* si ricade sulle transparent huge page (MADV_HUGEPAGE). La regione viene infine
+* associata al nodo NUMA su cui gira il processo, prima del primo accesso.
+* 
+* @param arena arena da preparare
+* @param size byte necessari, comprensivi dell'allineamento di ogni buffer
+* @param huge_pages richiede pagine da 2 MB
+* @return true se la regione è stata mappata
+*/
+bool arena_open(grid_arena *arena, size_t size, bool huge_pages) {
+    memset(arena, 0, sizeof(grid_arena));
+    arena->numa_node = -1;
+    arena->fd = -1;
+    arena->size = (size + ARENA_HUGE_PAGE - 1) / ARENA_HUGE_PAGE * ARENA_HUGE_PAGE;
+    arena->base = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (huge_pages) {
+        arena->base = mmap(NULL, arena->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        arena->pages = arena->base != MAP_FAILED ? ARENA_HUGETLB : ARENA_SMALL;
+    }
+#endif
+    if (arena->base == MAP_FAILED) {
+        arena->base = mmap(NULL, arena->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (arena->base == MAP_FAILED) {
+            return false;
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge_pages && madvise(arena->base, arena->size, MADV_HUGEPAGE) == 0) {
+            arena->pages = ARENA_THP;
+        }
+#endif
+    }
+#if defined(__linux__) && defined(SYS_getcpu) && defined(SYS_mbind)
+    /* preferisce il nodo NUMA corrente: le pagine vengono allocate lì al primo accesso */
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0 && node < 64) {
+        unsigned long mask = 1UL << node;
+        if (syscall(SYS_mbind, arena->base, arena->size, ARENA_MPOL_PREFERRED, &mask, 64, 0) == 0) {
+            arena->numa_node = (int)node;
+        }
+    }
+#endif
+    return true;
+}
+
+/* 
+* @brief Preleva dall'arena un buffer allineato ad ARENA_ALIGN byte
+* 
+* @param arena arena da cui prelevare
+* @param size byte del buffer
+* @return buffer (non inizializzato)
+*/
+char *arena_take(grid_arena *arena, size_t size) {
+    char *buffer = arena->base + arena->used;
+    arena->used += (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    return buffer;
+}
+
+/* 
+* @brief Rilascia l'arena e tutti i buffer prelevati
+* 
+* @param arena arena da rilasciare
+*/
+void arena_close(grid_arena *arena) {
+    munmap(arena->base, arena->size);
+    if (arena->fd >= 0) {
+        close(arena->fd);
+    }
+}
+
+/* 
+* @brief Prepara l'arena di un processo su un file, per porzioni più grandi della memoria
+* 
+* Il file viene creato nella cartella indicata, esteso alla dimensione dell'arena senza
+* scriverlo (le pagine mai toccate valgono zero come nella mmap anonima) e rimosso subito
+* dopo la mappatura: lo spazio su disco viene liberato alla chiusura o alla terminazione.
+* La mappatura è condivisa, quindi le pagine modificate vengono scritte sul file e il kernel
+* può rilasciarle. Le righe vengono percorse in ordine (MADV_SEQUENTIAL), la banda
+* successiva viene inoltre anticipata esplicitamente dal calcolo per bande.
+* 
+* @param arena arena da preparare
+* @param size byte necessari, comprensivi dell'allineamento di ogni buffer
+* @param dir cartella in cui creare il file
+* @return true se il file è stato creato e mappato
+*/
+bool arena_open_file(grid_arena *arena, size_t size, const char *dir) {
+    char path[PATH_MAX];
+    memset(arena, 0, sizeof(grid_arena));
+    arena->numa_node = -1;
+    arena->pages = ARENA_FILE;
+    arena->size = (size + ARENA_HUGE_PAGE - 1) / ARENA_HUGE_PAGE * ARENA_HUGE_PAGE;
+    snprintf(path, sizeof(path), "%s/gol.XXXXXX", dir);
+    arena->fd = mkstemp(path);
+    if (arena->fd < 0) {
+        return false;
+    }
+    unlink(path);
+    if (ftruncate(arena->fd, (off_t)arena->size) != 0) {
+        close(arena->fd);
+        return false;
+    }
+    arena->base = mmap(NULL, arena->size, PROT_READ | PROT_WRITE, MAP_SHARED, arena->fd, 0);
+    if (arena->base == MAP_FAILED) {
+        close(arena->fd);
+        return false;
+    }
+    madvise(arena->base, arena->size, MADV_SEQUENTIAL);
+    return true;
+}
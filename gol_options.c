@@ -0,0 +1,285 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Lettura delle opzioni da riga di comando
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "gol_engine.h"
+
+/* 
+* @brief Legge gli argomenti del programma
+* 
+* Tutte le impostazioni sono opzioni nella forma --nome=valore, in qualsiasi ordine.
+* Per compatibilità con le versioni precedenti sono accettati anche gli argomenti posizionali:
+* pattern generazioni, oppure righe colonne generazioni [test].
+* Opzioni disponibili:
+* --rows=n         righe della matrice (default 240)
+* --cols=n         colonne della matrice (default 360)
+* --generations=n  generazioni da calcolare (default 10)
+* --pattern=name   legge la matrice da patterns/name.txt, le dimensioni sono quelle del file
+* --print=on       mostra la matrice dopo ogni generazione
+* --kernel=name    kernel di calcolo: scalar, simd, lut, packed, ltl (default scalar)
+* --ltl=rule       regola Larger than Life nella forma R5,C0,M1,S34..58,B34..45,NM, sceglie il kernel ltl
+* --halo=name      scambio delle righe di bordo: ring, rma, shm, compact (default ring)
+* --engine=parallel|sequential motore di calcolo: sequential calcola l'intera matrice su MASTER (default parallel)
+* --verify=kernel  confronta ogni generazione con il motore sequenziale che usa il kernel indicato
+* --unbounded=on   piano illimitato: la matrice iniziale è posta nell'origine e la finestra segue le celle vive
+* --query=path     endpoint di interrogazione su socket Unix: rettangoli dell'ultima generazione su richiesta
+* --placement=rank|topology ordine dei processi nell'anello: per rank o raggruppati per nodo e socket (default rank)
+* --density=p      probabilità che una cella casuale sia viva (0 <= p <= 1)
+* --seed=n         seme comune per la generazione, riproducibile
+* --tile=name      ripete il pattern patterns/name.txt su tutta la matrice
+* --scatter=name:n inserisce n copie del pattern in posizioni casuali
+* --stats=file     scrive su file le statistiche di ogni generazione
+* --stop-period=p  termina in caso di estinzione, stato statico o oscillazione di periodo <= p
+* --ensemble=file  simula in modo indipendente le board elencate nel file (modalità ensemble)
+* --ensemble-out=file scrive su file i risultati della modalità ensemble
+* --threads=n      thread per processo nella modalità ensemble
+* --ensemble-kernel=scalar|sliced motore della modalità ensemble: sliced simula 64 board per parola (default scalar)
+* --hugepages=on   alloca la matrice su huge page (MAP_HUGETLB o transparent huge page)
+* --out-of-core=dir mappa la porzione di ogni processo su un file in dir e calcola le righe interne per bande
+* --band-rows=n    righe interne di una banda con --out-of-core (default 64)
+* --autotune=file  sceglie kernel, halo e progress con prove brevi, memorizzando la scelta nel file di tuning
+* --progress=none|test|thread fa avanzare lo scambio delle righe di bordo durante il calcolo
+* --progress-rows=n righe interne fra due MPI_Testall con --progress=test (default 16)
+* --viewport=RxC   mostra una mappa di densità RxC invece della matrice completa
+* --viewport-every=n generazioni fra due frame della viewport (default 1)
+* --viewport-format=ansi|pgm formato dei frame (default ansi)
+* --viewport-out=file scrive i frame su file invece che su stdout
+* --snapshot=n     salva la matrice ogni n generazioni tramite il thread di output
+* --snapshot-format=pbm|rle|delta formato degli snapshot (default pbm)
+* --snapshot-keyframe=k snapshot fra due keyframe del formato delta (default 64)
+* --snapshot-prefix=path prefisso dei file di snapshot (default snapshot)
+* --seek=gen       ricostruisce la generazione gen dai file delta con il prefisso indicato, senza simulare
+* 
+* @param argc numero di argomenti
+* @param argv argomenti passati al programma
+* @param opt opzioni da riempire
+* @return 0, -1 in caso di opzione o argomenti non validi
+*/
+int parse_options(int argc, char **argv, gol_options *opt) {
+    seed_options *seed = &opt->seed;
+    char *positional[4]; /* argomenti posizionali nella forma delle versioni precedenti */
+    int count = 0;
+    for (int i = 1; i < argc; i++) {
+        char *arg = argv[i];
+        char *value = strchr(arg, '=');
+        if (strncmp(arg, "--", 2) != 0) {
+            if (count == 4) {
+                return -1;
+            }
+            positional[count++] = arg;
+            continue;
+        }
+        if (value == NULL) {
+            return -1;
+        }
+        value++;
+        if (strncmp(arg, "--rows=", 7) == 0) {
+            opt->rows = atoll(value);
+        } else if (strncmp(arg, "--cols=", 7) == 0) {
+            opt->cols = atoll(value);
+        } else if (strncmp(arg, "--generations=", 14) == 0) {
+            opt->generations = atoi(value);
+            if (opt->generations < 0) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--pattern=", 10) == 0) {
+            opt->pattern_file = value;
+        } else if (strncmp(arg, "--print=", 8) == 0) {
+            opt->print = strcmp(value, "on") == 0;
+        } else if (strncmp(arg, "--kernel=", 9) == 0) {
+            opt->kernel = value;
+        } else if (strncmp(arg, "--ltl=", 6) == 0) {
+            opt->ltl = value;
+        } else if (strncmp(arg, "--halo=", 7) == 0) {
+            opt->halo = value;
+        } else if (strncmp(arg, "--engine=", 9) == 0) {
+            if (strcmp(value, "parallel") == 0) {
+                opt->engine = ENGINE_PARALLEL;
+            } else if (strcmp(value, "sequential") == 0) {
+                opt->engine = ENGINE_SEQUENTIAL;
+            } else {
+                return -1;
+            }
+        } else if (strncmp(arg, "--unbounded=", 12) == 0) {
+            opt->unbounded = strcmp(value, "on") == 0;
+        } else if (strncmp(arg, "--query=", 8) == 0) {
+            opt->query = value;
+        } else if (strncmp(arg, "--placement=", 12) == 0) {
+            if (strcmp(value, "rank") == 0) {
+                opt->topology = false;
+            } else if (strcmp(value, "topology") == 0) {
+                opt->topology = true;
+            } else {
+                return -1;
+            }
+        } else if (strncmp(arg, "--verify=", 9) == 0) {
+            opt->verify = value;
+        } else if (strncmp(arg, "--density=", 10) == 0) {
+            seed->density = atof(value);
+            if (seed->density < 0.0 || seed->density > 1.0) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            seed->seed = strtoull(value, NULL, 10);
+            seed->has_seed = true;
+        } else if (strncmp(arg, "--tile=", 7) == 0) {
+            seed->mode = SEED_TILE;
+            seed->pattern = value;
+        } else if (strncmp(arg, "--scatter=", 10) == 0) {
+            char *sep = strchr(value, ':');
+            if (sep == NULL) {
+                return -1;
+            }
+            *sep = '\0';
+            seed->mode = SEED_SCATTER;
+            seed->pattern = value;
+            seed->copies = atol(sep + 1);
+        } else if (strncmp(arg, "--stats=", 8) == 0) {
+            opt->stats_file = value;
+        } else if (strncmp(arg, "--ensemble=", 11) == 0) {
+            opt->ensemble_file = value;
+        } else if (strncmp(arg, "--ensemble-out=", 15) == 0) {
+            opt->ensemble_out = value;
+        } else if (strncmp(arg, "--ensemble-kernel=", 18) == 0) {
+            if (strcmp(value, "scalar") == 0) {
+                opt->ensemble_sliced = false;
+            } else if (strcmp(value, "sliced") == 0) {
+                opt->ensemble_sliced = true;
+            } else {
+                return -1;
+            }
+        } else if (strncmp(arg, "--snapshot=", 11) == 0) {
+            opt->snapshot_every = atoi(value);
+            if (opt->snapshot_every < 0) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--snapshot-format=", 18) == 0) {
+            if (strcmp(value, "pbm") == 0) {
+                opt->snapshot_format = SNAPSHOT_PBM;
+            } else if (strcmp(value, "rle") == 0) {
+                opt->snapshot_format = SNAPSHOT_RLE;
+            } else if (strcmp(value, "delta") == 0) {
+                opt->snapshot_format = SNAPSHOT_DELTA;
+            } else {
+                return -1;
+            }
+        } else if (strncmp(arg, "--snapshot-keyframe=", 20) == 0) {
+            opt->snapshot_keyframe = atoi(value);
+            if (opt->snapshot_keyframe < 1) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--seek=", 7) == 0) {
+            opt->seek = atoi(value);
+            if (opt->seek < 0) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--snapshot-prefix=", 18) == 0) {
+            opt->snapshot_prefix = value;
+        } else if (strncmp(arg, "--viewport=", 11) == 0) {
+            if (sscanf(value, "%dx%d", &opt->viewport_rows, &opt->viewport_cols) != 2
+                || opt->viewport_rows < 1 || opt->viewport_cols < 1) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--viewport-every=", 17) == 0) {
+            opt->viewport_every = atoi(value);
+            if (opt->viewport_every < 1) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--viewport-format=", 18) == 0) {
+            if (strcmp(value, "ansi") == 0) {
+                opt->viewport_format = VIEWPORT_ANSI;
+            } else if (strcmp(value, "pgm") == 0) {
+                opt->viewport_format = VIEWPORT_PGM;
+            } else {
+                return -1;
+            }
+        } else if (strncmp(arg, "--viewport-out=", 15) == 0) {
+            opt->viewport_out = value;
+        } else if (strncmp(arg, "--hugepages=", 12) == 0) {
+            opt->huge_pages = strcmp(value, "on") == 0;
+        } else if (strncmp(arg, "--autotune=", 11) == 0) {
+            opt->autotune = value;
+        } else if (strncmp(arg, "--out-of-core=", 14) == 0) {
+            opt->out_of_core = value;
+        } else if (strncmp(arg, "--band-rows=", 12) == 0) {
+            opt->band_rows = atoi(value);
+            if (opt->band_rows < 1) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--progress=", 11) == 0) {
+            if (strcmp(value, "none") == 0) {
+                opt->progress = PROGRESS_NONE;
+            } else if (strcmp(value, "test") == 0) {
+                opt->progress = PROGRESS_TEST;
+            } else if (strcmp(value, "thread") == 0) {
+                opt->progress = PROGRESS_THREAD;
+            } else {
+                return -1;
+            }
+            opt->progress_report = true;
+        } else if (strncmp(arg, "--progress-rows=", 16) == 0) {
+            opt->progress_rows = atoi(value);
+            if (opt->progress_rows < 1) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            opt->threads = atoi(value);
+            if (opt->threads < 1) {
+                return -1;
+            }
+        } else if (strncmp(arg, "--stop-period=", 14) == 0) {
+            opt->stop_period = atoi(value);
+            if (opt->stop_period < 0) {
+                return -1;
+            }
+        } else {
+            return -1;
+        }
+    }
+
+    switch (count) {
+    case 0:
+        break;
+    case 2: /* pattern da file e generazioni */
+        opt->pattern_file = positional[0];
+        opt->generations = atoi(positional[1]);
+        break;
+    case 4: /* dimensioni scelte dall'utente, la matrice viene stampata ad ogni iterazione */
+        opt->print = strcmp(positional[3], "test") == 0;
+        /* fall through */
+    case 3: /* dimensioni scelte dall'utente */
+        opt->rows = atoll(positional[0]);
+        opt->cols = atoll(positional[1]);
+        opt->generations = atoi(positional[2]);
+        break;
+    default:
+        return -1;
+    }
+
+    /* la modalità ensemble usa le regole B/S della sua lista */
+    if (opt->ltl != NULL && opt->ensemble_file != NULL) {
+        return -1;
+    }
+
+    /* nel piano illimitato le dimensioni cambiano: le uscite che raccolgono l'intera matrice non sono disponibili */
+    if (opt->unbounded && (opt->print || opt->verify != NULL || opt->snapshot_every > 0 || opt->viewport_rows > 0 ||
+                           opt->query != NULL || opt->out_of_core != NULL || opt->engine != ENGINE_PARALLEL || opt->ensemble_file != NULL)) {
+        return -1;
+    }
+
+    /* l'autotuning prova le configurazioni del motore parallelo su una porzione in memoria di dimensioni fisse */
+    if (opt->autotune != NULL && (opt->unbounded || opt->out_of_core != NULL || opt->engine != ENGINE_PARALLEL ||
+                                  opt->ensemble_file != NULL)) {
+        return -1;
+    }
+
+    /* l'endpoint di interrogazione segue il ciclo del motore parallelo */
+    if (opt->query != NULL && (opt->engine != ENGINE_PARALLEL || opt->ensemble_file != NULL)) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,467 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Endpoint di interrogazione: rettangoli dell'ultima generazione serviti su un socket Unix
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "gol_engine.h"
+
+/* tempo massimo per leggere una richiesta o scrivere una risposta, in secondi */
+#define QUERY_TIMEOUT 2
+
+/*
+* @brief Righe di un rettangolo possedute da un processo
+*
+* @param rect riga, colonna, righe e colonne del rettangolo
+* @param first prima riga posseduta
+* @param last riga successiva all'ultima posseduta
+* @param lo prima riga dell'intersezione
+* @return righe dell'intersezione
+*/
+static long long intersect(const long long *rect, long long first, long long last, long long *lo) {
+    long long hi = rect[0] + rect[2] < last ? rect[0] + rect[2] : last;
+    *lo = rect[0] > first ? rect[0] : first;
+    return hi > *lo ? hi - *lo : 0;
+}
+
+/*
+* @brief Scrive tutto il buffer sulla connessione, senza SIGPIPE se il client ha chiuso
+*
+* @return false se la connessione è chiusa o il client non legge entro QUERY_TIMEOUT
+*/
+static bool send_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+/*
+* @brief Risponde con un errore e chiude la connessione
+*/
+static void reply_error(int fd, const char *message) {
+    char line[128];
+    int len = snprintf(line, sizeof(line), "error %s\n", message);
+    send_all(fd, line, len);
+    close(fd);
+}
+
+/*
+* @brief Scrive il rettangolo richiesto, una riga di celle per riga di testo, e chiude la connessione
+*
+* @param request richiesta servita
+*/
+static void reply_cells(query_request *request) {
+    char header[128];
+    long long rows = request->rect[2], cols = request->rect[3];
+    int len = snprintf(header, sizeof(header), "generation %d rows %lld cols %lld\n", request->gen, rows, cols);
+    char *line = checked_alloc(cols + 1, 1);
+    bool ok = send_all(request->fd, header, len);
+    line[cols] = '\n';
+    for (long long i = 0; i < rows && ok; i++) {
+        memcpy(line, request->cells + i * cols, cols);
+        ok = send_all(request->fd, line, cols + 1);
+    }
+    free(line);
+    close(request->fd);
+}
+
+/*
+* @brief Accetta una connessione e accoda il rettangolo richiesto
+*
+* La richiesta è una riga di testo "riga colonna righe colonne". Le richieste non valide,
+* o oltre le QUERY_QUEUE in attesa, vengono rifiutate subito dal thread.
+*
+* @param server endpoint di interrogazione
+*/
+static void accept_request(query_server *server) {
+    struct timeval timeout = { QUERY_TIMEOUT, 0 };
+    char line[128];
+    size_t len = 0;
+    query_request request = { .gen = -1 };
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    /* un client lento blocca solo questo thread, mai il calcolo */
+    while (len < sizeof(line) - 1 && memchr(line, '\n', len) == NULL) {
+        ssize_t got = recv(fd, line + len, sizeof(line) - 1 - len, 0);
+        if (got <= 0) {
+            break;
+        }
+        len += got;
+    }
+    line[len] = '\0';
+    request.fd = fd;
+
+    long long *rect = request.rect;
+    const char *error = NULL;
+    if (sscanf(line, "%lld %lld %lld %lld", &rect[0], &rect[1], &rect[2], &rect[3]) != 4) {
+        error = "expected: row col rows cols";
+    } else if (rect[0] < 0 || rect[1] < 0 || rect[2] < 1 || rect[3] < 1 ||
+               rect[2] > server->row_size - rect[0] || rect[3] > server->col_size - rect[1]) {
+        error = "rectangle outside the matrix";
+    } else if (rect[2] > QUERY_MAX_CELLS / rect[3]) {
+        error = "rectangle too large";
+    }
+    pthread_mutex_lock(&server->lock);
+    if (error == NULL && server->closing) {
+        error = "simulation finished";
+    } else if (error == NULL && server->outstanding == QUERY_QUEUE) {
+        error = "busy";
+    }
+    if (error == NULL) {
+        server->waiting[server->waiting_count++] = request;
+        server->outstanding++;
+    } else {
+        server->rejected++;
+    }
+    pthread_mutex_unlock(&server->lock);
+    if (error != NULL) {
+        reply_error(fd, error);
+    }
+}
+
+/*
+* @brief Corpo del thread dell'endpoint: accetta le richieste e scrive le risposte pronte
+*
+* Il thread non effettua chiamate MPI: le richieste vengono prese dal calcolo fra due
+* generazioni e le risposte gli vengono restituite tramite la coda ready e la pipe wake.
+*
+* @param arg endpoint di interrogazione di MASTER
+* @return NULL
+*/
+static void *query_thread(void *arg) {
+    query_server *server = arg;
+    query_request ready[QUERY_QUEUE];
+    struct pollfd fds[2] = { { server->listen_fd, POLLIN, 0 }, { server->wake[0], POLLIN, 0 } };
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            if (read(server->wake[0], drain, sizeof(drain)) < 0) {
+                continue;
+            }
+        }
+        pthread_mutex_lock(&server->lock);
+        int count = server->ready_count;
+        bool closing = server->closing;
+        memcpy(ready, server->ready, count * sizeof(query_request));
+        server->ready_count = 0;
+        pthread_mutex_unlock(&server->lock);
+
+        /* le risposte vengono scritte fuori dal lock, il calcolo può accodarne altre */
+        for (int i = 0; i < count; i++) {
+            if (ready[i].cells != NULL) {
+                reply_cells(&ready[i]);
+                free(ready[i].cells);
+            } else {
+                reply_error(ready[i].fd, "simulation finished");
+            }
+        }
+        pthread_mutex_lock(&server->lock);
+        server->outstanding -= count;
+        pthread_mutex_unlock(&server->lock);
+
+        if (closing) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            accept_request(server);
+        }
+    }
+
+    /* le richieste mai inviate ai processi ricevono un errore */
+    pthread_mutex_lock(&server->lock);
+    for (int i = 0; i < server->waiting_count; i++) {
+        reply_error(server->waiting[i].fd, "simulation finished");
+    }
+    server->rejected += server->waiting_count;
+    server->waiting_count = 0;
+    pthread_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+/*
+* @brief Sveglia il thread dell'endpoint
+*/
+static void wake_thread(query_server *server) {
+    /* se la pipe è piena il thread ha già un risveglio in sospeso */
+    ssize_t written = write(server->wake[1], "", 1);
+    (void)written;
+}
+
+/*
+* @brief Consegna al thread le risposte e lo sveglia
+*
+* @param server endpoint di interrogazione di MASTER
+* @param requests risposte da scrivere
+* @param count numero di risposte
+*/
+static void push_ready(query_server *server, query_request *requests, int count) {
+    pthread_mutex_lock(&server->lock);
+    for (int i = 0; i < count; i++) {
+        server->ready[server->ready_count++] = requests[i];
+        if (requests[i].cells != NULL) {
+            server->served++;
+        } else {
+            server->rejected++;
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+    wake_thread(server);
+}
+
+/*
+* @brief Prende dalla coda le richieste del prossimo giro e le scrive nel blocco da inviare
+*
+* @param server endpoint di interrogazione di MASTER
+*/
+static void take_waiting(query_server *server) {
+    long long *block = server->block[0];
+    int count = 0;
+    long long cells = 0;
+    pthread_mutex_lock(&server->lock);
+    while (count < server->waiting_count && count < QUERY_BATCH) {
+        const long long *rect = server->waiting[count].rect;
+        if (cells + rect[2] * rect[3] > QUERY_MAX_CELLS) {
+            break;
+        }
+        cells += rect[2] * rect[3];
+        server->round[0][count] = server->waiting[count];
+        memcpy(&block[1 + 4 * count], rect, 4 * sizeof(long long));
+        count++;
+    }
+    server->waiting_count -= count;
+    memmove(server->waiting, server->waiting + count, server->waiting_count * sizeof(query_request));
+    pthread_mutex_unlock(&server->lock);
+    block[0] = count;
+}
+
+/*
+* @brief Copia le parti dei rettangoli possedute e avvia la raccolta su MASTER
+*
+* Ogni processo invia le sue righe di tutti i rettangoli del giro in un unico messaggio,
+* rettangolo dopo rettangolo: MASTER le riceve ordinate per processo.
+*
+* @param server endpoint di interrogazione
+* @param gen generazione della porzione
+* @param slab prima riga posseduta della porzione
+*/
+static void start_gather(query_server *server, int gen, const char *slab) {
+    const long long *block = server->block[1];
+    long long first = server->displ_for_proc[server->rank], last = first + server->rows_for_proc[server->rank];
+    size_t size = 0;
+    for (int k = 0; k < block[0]; k++) {
+        const long long *rect = &block[1 + 4 * k];
+        long long lo, rows = intersect(rect, first, last, &lo);
+        for (long long i = lo; i < lo + rows; i++) {
+            memcpy(server->send + size, slab + (i - first) * server->col_size + rect[1], rect[3]);
+            size += rect[3];
+        }
+    }
+    if (server->rank == MASTER) {
+        int offset = 0;
+        for (int p = 0; p < server->num_proc; p++) {
+            long long p_first = server->displ_for_proc[p], p_last = p_first + server->rows_for_proc[p];
+            server->displs[p] = offset;
+            server->counts[p] = 0;
+            for (int k = 0; k < block[0]; k++) {
+                long long lo;
+                server->counts[p] += (int)(intersect(&block[1 + 4 * k], p_first, p_last, &lo) * block[4 + 4 * k]);
+            }
+            offset += server->counts[p];
+        }
+        for (int k = 0; k < block[0]; k++) {
+            server->round[1][k].gen = gen;
+        }
+    }
+    MPI_Igatherv(server->send, (int)size, MPI_CHAR, server->recv, server->counts, server->displs, MPI_CHAR,
+                 MASTER, MPI_COMM_WORLD, &server->gather);
+    server->gather_active = true;
+}
+
+/*
+* @brief Ricompone i rettangoli raccolti e li consegna al thread
+*
+* @param server endpoint di interrogazione di MASTER
+*/
+static void finish_gather(query_server *server) {
+    const long long *block = server->block[1];
+    int count = (int)block[0];
+    for (int k = 0; k < count; k++) {
+        server->round[1][k].cells = checked_alloc(block[3 + 4 * k], block[4 + 4 * k]);
+    }
+    for (int p = 0; p < server->num_proc; p++) {
+        long long p_first = server->displ_for_proc[p], p_last = p_first + server->rows_for_proc[p];
+        const char *part = server->recv + server->displs[p];
+        for (int k = 0; k < count; k++) {
+            const long long *rect = &block[1 + 4 * k];
+            long long lo, rows = intersect(rect, p_first, p_last, &lo);
+            memcpy(server->round[1][k].cells + (lo - rect[0]) * rect[3], part, rows * rect[3]);
+            part += rows * rect[3];
+        }
+    }
+    push_ready(server, server->round[1], count);
+}
+
+/*
+* @brief Apre l'endpoint di interrogazione: MASTER crea il socket e avvia il thread
+*
+* Operazione collettiva, con lo stesso esito su tutti i processi.
+*
+* @param server endpoint da preparare
+* @param path percorso del socket Unix
+* @param rank rank del processo corrente
+* @param num_proc numero di processi
+* @param row_size righe della matrice
+* @param col_size colonne della matrice
+* @param rows_for_proc righe assegnate ad ogni processo
+* @param displ_for_proc indice della prima riga di ogni processo
+* @return false se il socket non può essere creato
+*/
+bool query_open(query_server *server, const char *path, int rank, int num_proc, long long row_size, long long col_size,
+                const int *rows_for_proc, const int *displ_for_proc) {
+    int ok = 1;
+    memset(server, 0, sizeof(query_server));
+    server->rank = rank;
+    server->num_proc = num_proc;
+    server->row_size = row_size;
+    server->col_size = col_size;
+    server->rows_for_proc = rows_for_proc;
+    server->displ_for_proc = displ_for_proc;
+    server->path = path;
+    server->listen_fd = -1;
+    /* le parti possedute di un giro non superano QUERY_MAX_CELLS celle, né la porzione per ogni rettangolo */
+    long long slab_cells = (long long)rows_for_proc[rank] * col_size;
+    server->send = checked_alloc(slab_cells < QUERY_MAX_CELLS / QUERY_BATCH ? slab_cells * QUERY_BATCH : QUERY_MAX_CELLS, 1);
+
+    if (rank == MASTER) {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        struct stat info;
+        server->recv = checked_alloc(QUERY_MAX_CELLS, 1);
+        server->counts = checked_alloc(num_proc, sizeof(int));
+        server->displs = checked_alloc(num_proc, sizeof(int));
+        /* un socket rimasto da un'esecuzione precedente viene sostituito, un altro file no */
+        if (stat(path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+            unlink(path);
+        }
+        server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (strlen(path) >= sizeof(addr.sun_path) || server->listen_fd < 0 || pipe(server->wake) != 0) {
+            ok = 0;
+        } else {
+            /* il calcolo non deve mai attendere il thread, nemmeno sulla pipe */
+            fcntl(server->wake[1], F_SETFL, O_NONBLOCK);
+            strcpy(addr.sun_path, path);
+            ok = bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0 && listen(server->listen_fd, QUERY_QUEUE) == 0;
+        }
+        if (ok) {
+            pthread_mutex_init(&server->lock, NULL);
+            pthread_create(&server->thread, NULL, query_thread, server);
+        } else if (server->listen_fd >= 0) {
+            close(server->listen_fd);
+        }
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, MASTER, MPI_COMM_WORLD);
+    return ok;
+}
+
+/*
+* @brief Avanza l'endpoint di una generazione, chiamata da tutti i processi dopo ogni generazione
+*
+* Ogni giro richiede due generazioni: i rettangoli accodati vengono inviati a tutti i
+* processi con MPI_Ibcast, alla generazione successiva ogni processo copia le sue righe
+* dell'ultima generazione calcolata e le invia a MASTER con MPI_Igatherv, completata
+* alla generazione dopo ancora. Le decisioni dipendono solo dal blocco ricevuto, quindi
+* le operazioni collettive sono avviate nello stesso ordine su tutti i processi. Il
+* calcolo attende solo le operazioni MPI, mai un client: socket e risposte sono gestiti
+* dal thread di MASTER.
+*
+* @param server endpoint di interrogazione
+* @param gen generazione appena calcolata
+* @param slab prima riga posseduta della porzione della generazione gen
+*/
+void query_step(query_server *server, int gen, const char *slab) {
+    if (server->gather_active) {
+        MPI_Wait(&server->gather, MPI_STATUS_IGNORE);
+        server->gather_active = false;
+        if (server->rank == MASTER) {
+            finish_gather(server);
+        }
+    }
+    if (server->bcast_active) {
+        MPI_Wait(&server->bcast, MPI_STATUS_IGNORE);
+        server->bcast_active = false;
+        if (server->block[0][0] > 0) {
+            memcpy(server->block[1], server->block[0], sizeof(server->block[0]));
+            memcpy(server->round[1], server->round[0], sizeof(server->round[0]));
+            start_gather(server, gen, slab);
+        }
+    }
+    if (server->rank == MASTER) {
+        take_waiting(server);
+    }
+    MPI_Ibcast(server->block[0], 1 + 4 * QUERY_BATCH, MPI_LONG_LONG, MASTER, MPI_COMM_WORLD, &server->bcast);
+    server->bcast_active = true;
+}
+
+/*
+* @brief Chiude l'endpoint: completa la raccolta in corso e risponde con un errore alle altre richieste
+*
+* Operazione collettiva.
+*
+* @param server endpoint da chiudere
+*/
+void query_close(query_server *server) {
+    if (server->gather_active) {
+        MPI_Wait(&server->gather, MPI_STATUS_IGNORE);
+        if (server->rank == MASTER) {
+            finish_gather(server);
+        }
+    }
+    if (server->bcast_active) {
+        MPI_Wait(&server->bcast, MPI_STATUS_IGNORE);
+        /* le richieste appena inviate ai processi non vengono più raccolte */
+        if (server->rank == MASTER) {
+            push_ready(server, server->round[0], (int)server->block[0][0]);
+        }
+    }
+    if (server->rank == MASTER) {
+        pthread_mutex_lock(&server->lock);
+        server->closing = true;
+        pthread_mutex_unlock(&server->lock);
+        wake_thread(server);
+        pthread_join(server->thread, NULL);
+        pthread_mutex_destroy(&server->lock);
+        close(server->listen_fd);
+        close(server->wake[0]);
+        close(server->wake[1]);
+        unlink(server->path);
+        free(server->recv);
+        free(server->counts);
+        free(server->displs);
+    }
+    free(server->send);
+}
@@ -0,0 +1,181 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Motore sequenziale di riferimento: l'intera matrice toroidale su un solo core
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#include "gol_engine.h"
+
+/*
+ * @brief Alloca la matrice completa del motore di riferimento
+ * 
+ * Come le porzioni del motore parallelo, ogni buffer ha depth righe fantasma prima
+ * e dopo le righe della matrice, così gli stessi kernel calcolano tutte le righe.
+ * 
+ * @param board matrice da preparare
+ * @param rows numero di righe, almeno depth
+ * @param cols numero di colonne
+ * @param depth righe fantasma per lato, pari al raggio del vicinato del kernel
+ */
+void reference_open(reference_board *board, int rows, long long cols, int depth) {
+    board->rows = rows;
+    board->cols = cols;
+    board->depth = depth;
+    board->current = 0;
+    for (int b = 0; b < 2; b++) {
+        board->buffers[b] = (char *)checked_alloc((size_t)rows + 2 * depth, cols) + (size_t)depth * cols;
+    }
+}
+
+/*
+ * @brief Calcola la generazione successiva dell'intera matrice
+ * 
+ * Le righe fantasma ricevono le ultime e le prime righe, tenendo conto del toroide,
+ * poi il kernel calcola tutte le righe in un'unica passata.
+ * 
+ * @param board matrice da far avanzare
+ * @param kernel kernel di calcolo
+ * @param stats statistiche della nuova generazione, NULL se disabilitate
+ */
+void reference_step(reference_board *board, const gol_kernel *kernel, gen_stats *stats) {
+    char *origin = board->buffers[board->current], *result = board->buffers[1 - board->current];
+    long long cols = board->cols;
+    size_t ghost_bytes = (size_t)board->depth * cols;
+    memcpy(origin - ghost_bytes, origin + (size_t)(board->rows - board->depth) * cols, ghost_bytes);
+    memcpy(origin + (size_t)board->rows * cols, origin, ghost_bytes);
+    if (stats != NULL) {
+        reset_stats(stats);
+    }
+    compute_rows(kernel, origin, result, 0, board->rows, cols, 0, stats);
+    board->current = 1 - board->current;
+}
+
+/*
+ * @brief Libera la matrice del motore di riferimento
+ * 
+ * @param board matrice da liberare
+ */
+void reference_close(reference_board *board) {
+    for (int b = 0; b < 2; b++) {
+        free(board->buffers[b] - (size_t)board->depth * board->cols);
+    }
+}
+
+/*
+ * @brief Esegue il gioco con il motore sequenziale di riferimento
+ * 
+ * La matrice iniziale è la stessa del motore parallelo con le stesse opzioni,
+ * quindi risultati e statistiche sono confrontabili bit per bit. Il tempo riportato
+ * comprende solo il calcolo delle generazioni: la stampa della matrice e la scrittura
+ * delle statistiche ne sono escluse.
+ * 
+ * @param opt opzioni da riga di comando
+ * @param kernel kernel di calcolo
+ */
+void run_sequential(gol_options *opt, const gol_kernel *kernel) {
+    long long row_size, col_size;
+    char *file = NULL;
+    bool show_matrix;
+    reference_board board;
+    gen_stats local_stats, *stats = NULL;
+    cycle_window window = { 0, NULL, 0 };
+    FILE *stats_out = NULL;
+    int cycle = CYCLE_NONE, gen;
+    int radius = kernel_radius(kernel);
+    double compute_time = 0.0;
+
+    if (opt->pattern_file != NULL) {
+        file = pattern_path(opt->pattern_file);
+        printf("--Generate game matrix seed from %s--\n", file);
+        check_matrix_size(file, &row_size, &col_size);
+    } else {
+        row_size = opt->rows;
+        col_size = opt->cols;
+    }
+    if (row_size < radius || row_size > INT_MAX || col_size < 1 || col_size > LLONG_MAX / row_size) {
+        printf("Error, invalid matrix size %lld x %lld.\n", row_size, col_size);
+        free(file);
+        return;
+    }
+    show_matrix = (file != NULL || opt->print) && opt->viewport_rows == 0;
+
+    reference_open(&board, (int)row_size, col_size, radius);
+    if (file != NULL) {
+        init_from_file(board.buffers[0], row_size, col_size, file);
+        free(file);
+    } else {
+        if (!opt->seed.has_seed) {
+            opt->seed.seed = (uint64_t)time(NULL);
+        }
+        if (!seed_slab(&opt->seed, board.buffers[0], 0, (int)row_size, row_size, col_size)) {
+            printf("Error, pattern %s not found.\n", opt->seed.pattern);
+            reference_close(&board);
+            return;
+        }
+    }
+    printf("Settings: generations %d \trows %lld \tcolumns %lld \tkernel %s \tengine sequential\n",
+           opt->generations, row_size, col_size, kernel->name);
+
+    if (opt->stop_period > 0) {
+        stats = &local_stats;
+        window.period = opt->stop_period;
+        window.hashes = calloc(opt->stop_period + 1, sizeof(uint64_t));
+    }
+    if (opt->stats_file != NULL) {
+        stats = &local_stats;
+        stats_out = fopen(opt->stats_file, "w");
+        if (stats_out == NULL) {
+            printf("Error, cannot open %s.\n", opt->stats_file);
+            reference_close(&board);
+            free(window.hashes);
+            return;
+        }
+        fprintf(stats_out, "# generation live births deaths min_row min_col max_row max_col\n");
+    }
+    if (show_matrix) {
+        print_matrix(0, board.buffers[0], (int)row_size, col_size);
+    }
+
+    for (gen = 0; gen <= opt->generations; gen++) {
+        if (gen > 0) {
+            double start = MPI_Wtime();
+            reference_step(&board, kernel, stats);
+            compute_time += MPI_Wtime() - start;
+            if (show_matrix) {
+                print_matrix(gen, board.buffers[board.current], (int)row_size, col_size);
+            }
+        } else if (stats != NULL) {
+            slab_stats(board.buffers[0], (int)row_size, col_size, 0, stats);
+        }
+        if (stats != NULL) {
+            long long bounds[4] = { stats->min_row, stats->min_col, stats->max_row, stats->max_col };
+            if (stats_out != NULL) {
+                print_stats(stats_out, gen, stats->live, stats->births, stats->deaths, bounds);
+            }
+            if (opt->stop_period > 0) {
+                cycle = check_cycle(&window, stats->live, stats->hash);
+                if (cycle != CYCLE_NONE) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (cycle == CYCLE_EXTINCTION) {
+        printf("Early stop: extinction at generation %d\n", gen);
+    } else if (cycle == 1) {
+        printf("Early stop: still life at generation %d\n", gen);
+    } else if (cycle != CYCLE_NONE) {
+        printf("Early stop: period %d oscillation at generation %d\n", cycle, gen);
+    }
+    if (stats_out != NULL) {
+        fclose(stats_out);
+    }
+    free(window.hashes);
+    reference_close(&board);
+    printf("\nExecution Time: %f ms\n", compute_time);
+}
@@ -0,0 +1,330 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Generazione della matrice di partenza: pattern da file, seed casuali e pattern ripetuti
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "gol_engine.h"
+
+/* 
+* @brief Mostra una matrice su stdout 
+* 
+* @param gen numero di generazione mostrata
+* @param matrice da mostrare
+* @param rows numero di righe della matrice
+* @param cols numero di colonne della matrice
+*/
+void print_matrix(int gen, char *mat, int rows, long long cols)
+{
+    printf("\nGeneration %d:\n", gen);
+    for (int i = 0; i < rows; i++) {
+        for (long long j = 0; j < cols; j++) {
+            printf("%c", mat[i * cols + j]);
+        }
+        printf("\n");
+    }
+}
+
+/* 
+* @brief Inizializza una matrice da file
+* 
+* @param mat matrice da riempire
+* @param rows numero di righe della matrice
+* @param cols numero di colonne della matrice
+* @param file file da cui prendere i dati
+*/
+void init_from_file(char *mat, long long rows, long long cols, char *file) {
+    /* carattere letto */
+    char c; 
+    FILE *fptr;
+    fptr = fopen(file, "r");
+    for (long long i = 0; i < rows; i++) {
+        for (long long j = 0; j < cols; j++) {
+            fscanf(fptr, "%c ", &c);
+            mat[i * cols + j] = c;
+        }
+    }
+    fclose(fptr);
+}
+
+void init_test_matrix(char *mat, long long rows, long long cols) {
+    for (long long i = 0; i < rows; i++) {
+        for (long long j = 0; j < cols; j++) {
+            mat[i * cols + j] = DEAD;
+        }
+    }
+}
+
+/* 
+* @brief Setta il valore di righe e colonne in base al file pattern caricato 
+* 
+* @param filename path del file scelto
+* @param row_size indirizzo variabile in cui memorizzare il numero di righe
+* @param col_size indirizzo var in cui memorizzare il numero di colonne
+*/
+void check_matrix_size(char *filename, long long *row_size, long long *col_size) {
+    long long rows = 0, lines = 0;
+    char c;
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) {
+        printf("Error.\n");
+        return;
+    }
+    /* conteggia righe e colonne del file */
+    while ((c = fgetc(file)) != EOF) {
+        if (c == '\n') { rows++; }
+        if (c == '.' || c == 'O') { lines++; }
+    }
+    /* caso speciale ultima riga */
+    if (lines > 0) { rows++; }
+    /* setta il valore di righe e colonne */
+    *row_size = rows;
+    *col_size = lines / rows;
+    fclose(file);
+}
+
+/* 
+* @brief Costruisce il path di un file pattern a partire dal suo nome
+* 
+* @param name nome del pattern senza estensione
+* @return path allocato dinamicamente (patterns/<name>.txt)
+*/
+char *pattern_path(char *name) {
+    char *dir = "patterns/", *ext = ".txt";
+    char *file = malloc(strlen(dir) + strlen(name) + strlen(ext) + 1);
+    sprintf(file, "%s%s%s", dir, name, ext);
+    return file;
+}
+
+/* 
+* @brief Carica in memoria un pattern, allocando una matrice delle sue dimensioni
+* 
+* @param name nome del pattern senza estensione
+* @param rows indirizzo in cui memorizzare il numero di righe del pattern
+* @param cols indirizzo in cui memorizzare il numero di colonne del pattern
+* @return matrice del pattern, NULL se il file non esiste o è vuoto
+*/
+char *load_pattern(char *name, int *rows, int *cols) {
+    char *file = pattern_path(name);
+    char *pattern = NULL;
+    FILE *fptr = fopen(file, "r");
+    long long pat_rows = 0, pat_cols = 0;
+
+    *rows = 0;
+    *cols = 0;
+    if (fptr != NULL) {
+        fclose(fptr);
+        check_matrix_size(file, &pat_rows, &pat_cols);
+        /* i pattern sono piccoli, le loro dimensioni restano int */
+        if (pat_rows > 0 && pat_cols > 0 && pat_rows <= INT_MAX && pat_cols <= INT_MAX) {
+            *rows = (int)pat_rows;
+            *cols = (int)pat_cols;
+            pattern = checked_alloc((size_t)pat_rows * pat_cols, sizeof(char));
+            init_from_file(pattern, pat_rows, pat_cols, file);
+        }
+    }
+    free(file);
+    return pattern;
+}
+
+/* 
+* @brief Riempie la porzione di un processo con celle vive con probabilità density
+* 
+* Lo stato di ogni cella dipende solo dal seme e dalla sua posizione globale,
+* quindi la matrice generata non cambia al variare del numero di processi.
+* 
+* @param mat porzione da riempire
+* @param first_row indice globale della prima riga della porzione
+* @param rows numero di righe della porzione
+* @param cols numero di colonne della matrice
+* @param density probabilità che una cella sia viva
+* @param seed seme comune a tutti i processi
+*/
+void init_random(char *mat, long long first_row, int rows, long long cols, double density, uint64_t seed) {
+    /* soglia sui 53 bit più significativi, density 1.0 rende vive tutte le celle */
+    uint64_t threshold = (uint64_t)(density * 9007199254740992.0);
+    uint64_t key = mix64(seed);
+    for (int i = 0; i < rows; i++) {
+        uint64_t base = (uint64_t)(first_row + i) * cols;
+        for (long long j = 0; j < cols; j++) {
+            mat[(size_t)i * cols + j] = (mix64(key ^ (base + j)) >> 11) < threshold ? ALIVE : DEAD;
+        }
+    }
+}
+
+/* 
+* @brief Riempie la porzione di un processo ripetendo un pattern su tutta la matrice
+* 
+* @param mat porzione da riempire
+* @param first_row indice globale della prima riga della porzione
+* @param rows numero di righe della porzione
+* @param cols numero di colonne della matrice
+* @param pattern matrice del pattern
+* @param pat_rows numero di righe del pattern
+* @param pat_cols numero di colonne del pattern
+*/
+void init_tiled(char *mat, long long first_row, int rows, long long cols, char *pattern, int pat_rows, int pat_cols) {
+    for (int i = 0; i < rows; i++) {
+        char *pat_row = pattern + ((first_row + i) % pat_rows) * pat_cols;
+        for (long long j = 0; j < cols; j++) {
+            mat[(size_t)i * cols + j] = pat_row[j % pat_cols];
+        }
+    }
+}
+
+/*
+* @brief Riga superiore della copia k-esima di un pattern sparso
+*
+* Le righe della matrice sono divise in copies fasce consecutive e la copia k cade
+* in un punto casuale della fascia k: le righe superiori crescono con k, così ogni
+* processo può ricavare le copie che toccano la sua porzione senza scorrerle tutte.
+* Con più copie che righe, più copie consecutive condividono la stessa riga.
+*
+* @param k indice della copia
+* @param copies numero di copie
+* @param row_size numero di righe della matrice
+* @param key seme già mescolato, comune a tutti i processi
+* @return riga superiore della copia
+*/
+static long long scatter_top(long k, long copies, long long row_size, uint64_t key) {
+    long long lo = (long long)((unsigned __int128)k * row_size / copies);
+    long long hi = (long long)((unsigned __int128)(k + 1) * row_size / copies);
+    return hi > lo ? lo + (long long)(mix64(key ^ (2 * k)) % (uint64_t)(hi - lo)) : lo;
+}
+
+/*
+* @brief Prima copia la cui fascia può contenere righe superiori da top in poi
+*
+* @param top riga superiore minima
+* @param copies numero di copie
+* @param row_size numero di righe della matrice
+* @return indice della prima copia da considerare
+*/
+static long scatter_first(long long top, long copies, long long row_size) {
+    /* solo la fascia che precede la prima con inizio da top in poi può contenere top */
+    long k = (long)(((unsigned __int128)top * copies + row_size - 1) / row_size) - 1;
+    return k > 0 ? k : 0;
+}
+
+/*
+* @brief Ultima copia con la fascia che inizia entro la riga top
+*
+* @param top riga superiore massima
+* @param copies numero di copie
+* @param row_size numero di righe della matrice
+* @return indice dell'ultima copia da considerare
+*/
+static long scatter_last(long long top, long copies, long long row_size) {
+    /* la fascia k inizia entro top se k * row_size < (top + 1) * copies */
+    long k = (long)(((unsigned __int128)(top + 1) * copies - 1) / row_size);
+    return k < copies - 1 ? k : copies - 1;
+}
+
+/*
+* @brief Scrive nella porzione le copie con la riga superiore in [top_lo, top_hi]
+*/
+static void scatter_copies(char *mat, long long first_row, int rows, long long row_size, long long col_size,
+                           const char *pattern, int pat_rows, int pat_cols, long copies, uint64_t key,
+                           long long top_lo, long long top_hi) {
+    for (long k = scatter_first(top_lo, copies, row_size); k <= scatter_last(top_hi, copies, row_size); k++) {
+        /* angolo in alto a sinistra della copia k-esima */
+        long long top = scatter_top(k, copies, row_size, key);
+        long long left = (long long)(mix64(key ^ (2 * k + 1)) % col_size);
+        if (top < top_lo || top > top_hi) {
+            continue;
+        }
+        for (int pi = 0; pi < pat_rows; pi++) {
+            long long local_row = (top + pi) % row_size - first_row;
+            if (local_row < 0 || local_row >= rows) {
+                continue;
+            }
+            for (int pj = 0; pj < pat_cols; pj++) {
+                if (pattern[pi * pat_cols + pj] == ALIVE) {
+                    mat[local_row * col_size + (left + pj) % col_size] = ALIVE;
+                }
+            }
+        }
+    }
+}
+
+/* 
+* @brief Riempie la porzione di un processo con copie di un pattern in posizioni casuali
+* 
+* Tutti i processi calcolano le stesse posizioni a partire dal seme comune, ma ognuno
+* visita solo le copie con la riga superiore fra pat_rows - 1 righe prima della porzione
+* e la sua ultima riga, quindi il costo segue le righe locali e non il numero di copie.
+* Le copie che escono dai bordi proseguono sul lato opposto (toroide).
+* 
+* @param mat porzione da riempire
+* @param first_row indice globale della prima riga della porzione
+* @param rows numero di righe della porzione
+* @param row_size numero di righe della matrice
+* @param col_size numero di colonne della matrice
+* @param pattern matrice del pattern
+* @param pat_rows numero di righe del pattern
+* @param pat_cols numero di colonne del pattern
+* @param copies numero di copie da inserire
+* @param seed seme comune a tutti i processi
+*/
+void init_scattered(char *mat, long long first_row, int rows, long long row_size, long long col_size,
+                    char *pattern, int pat_rows, int pat_cols, long copies, uint64_t seed) {
+    memset(mat, DEAD, (size_t)rows * col_size);
+    if (copies < 1 || rows < 1) {
+        return;
+    }
+    uint64_t key = mix64(seed);
+    long long top_lo = first_row - pat_rows + 1, top_hi = first_row + rows - 1;
+    if (top_hi - top_lo + 1 >= row_size) {
+        scatter_copies(mat, first_row, rows, row_size, col_size, pattern, pat_rows, pat_cols, copies, key, 0, row_size - 1);
+    } else if (top_lo < 0) {
+        /* copie che iniziano in fondo alla matrice e proseguono dalla prima riga */
+        scatter_copies(mat, first_row, rows, row_size, col_size, pattern, pat_rows, pat_cols, copies, key, 0, top_hi);
+        scatter_copies(mat, first_row, rows, row_size, col_size, pattern, pat_rows, pat_cols, copies, key,
+                       top_lo + row_size, row_size - 1);
+    } else {
+        scatter_copies(mat, first_row, rows, row_size, col_size, pattern, pat_rows, pat_cols, copies, key, top_lo, top_hi);
+    }
+}
+
+/*
+ * @brief Genera una porzione della matrice secondo le impostazioni del seed
+ * 
+ * Il seme deve essere già stato scelto e deve essere lo stesso per tutti i processi:
+ * ogni cella dipende solo dalla sua posizione globale, quindi il risultato non dipende
+ * dalla divisione in porzioni.
+ * 
+ * @param seed impostazioni del seed
+ * @param mat porzione da riempire
+ * @param first_row indice globale della prima riga della porzione
+ * @param rows numero di righe della porzione
+ * @param row_size righe della matrice globale
+ * @param col_size colonne della matrice
+ * @return false se il pattern indicato non esiste
+ */
+bool seed_slab(seed_options *seed, char *mat, long long first_row, int rows, long long row_size, long long col_size) {
+    char *pattern = NULL;
+    int pat_rows = 0, pat_cols = 0;
+    if (seed->mode != SEED_RANDOM) {
+        /* il pattern è piccolo, ogni processo lo legge autonomamente */
+        pattern = load_pattern(seed->pattern, &pat_rows, &pat_cols);
+        if (pattern == NULL) {
+            return false;
+        }
+    }
+    switch (seed->mode) {
+    case SEED_TILE:
+        init_tiled(mat, first_row, rows, col_size, pattern, pat_rows, pat_cols);
+        break;
+    case SEED_SCATTER:
+        init_scattered(mat, first_row, rows, row_size, col_size, pattern, pat_rows, pat_cols, seed->copies, seed->seed);
+        break;
+    default:
+        init_random(mat, first_row, rows, col_size, seed->density, seed->seed);
+        break;
+    }
+    free(pattern);
+    return true;
+}
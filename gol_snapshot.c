@@ -0,0 +1,367 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Stadio di output asincrono degli snapshot
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gol_engine.h"
+
+/*
+ * @brief Codifica le righe di una porzione in formato PBM binario (P4)
+ * 
+ * Ogni riga occupa (cols + 7) / 8 byte, il bit più significativo è la prima colonna
+ * e una cella viva corrisponde a un bit a 1.
+ * 
+ * @param slab porzione da codificare
+ * @param rows numero di righe della porzione
+ * @param cols numero di colonne della matrice
+ * @param out buffer di rows * ((cols + 7) / 8) byte
+ */
+void pack_rows(const char *slab, int rows, long long cols, unsigned char *out) {
+    size_t row_bytes = (cols + 7) / 8;
+    memset(out, 0, rows * row_bytes);
+    for (int i = 0; i < rows; i++) {
+        unsigned char *packed = out + (size_t)i * row_bytes;
+        const char *row = slab + (size_t)i * cols;
+        for (long long j = 0; j < cols; j++) {
+            if (row[j] == ALIVE) {
+                packed[j >> 3] |= 0x80 >> (j & 7);
+            }
+        }
+    }
+}
+
+/*
+ * @brief Scrive uno snapshot nel file PBM globale della generazione
+ * 
+ * Tutti i processi scrivono in parallelo la propria porzione di righe all'offset
+ * corrispondente, MASTER scrive anche l'intestazione e porta il file alla dimensione
+ * esatta, così un file esistente più grande non lascia byte in coda. Ridurre o estendere
+ * alla dimensione finale non cambia i byte già scritti, quindi l'ordine non conta.
+ * 
+ * @param writer stadio di output del processo
+ * @param gen generazione dello snapshot
+ * @param slab copia della porzione del processo
+ */
+static void write_pbm(snapshot_writer *writer, int gen, const char *slab) {
+    char path[PATH_MAX], header[64];
+    size_t row_bytes = (writer->cols + 7) / 8;
+    int header_len = snprintf(header, sizeof(header), "P4\n%lld %lld\n", writer->cols, writer->row_size);
+    off_t offset = header_len + (off_t)writer->first_row * row_bytes;
+
+    snprintf(path, sizeof(path), "%s_%06d.pbm", writer->prefix, gen);
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        writer->errors++;
+        return;
+    }
+    pack_rows(slab, writer->rows, writer->cols, writer->packed);
+    if (writer->rank == MASTER && (ftruncate(fd, header_len + (off_t)writer->row_size * row_bytes) != 0 ||
+                                   pwrite(fd, header, header_len, 0) != header_len)) {
+        writer->errors++;
+    }
+    if (pwrite(fd, writer->packed, (size_t)writer->rows * row_bytes, offset) != (ssize_t)((size_t)writer->rows * row_bytes)) {
+        writer->errors++;
+    }
+    close(fd);
+}
+
+/*
+ * @brief Accoda uno snapshot al file RLE del processo
+ * 
+ * Ogni snapshot è un blocco in formato RLE (b cella morta, o cella viva, $ fine riga)
+ * preceduto da un commento con generazione e righe globali della porzione.
+ * 
+ * @param writer stadio di output del processo
+ * @param gen generazione dello snapshot
+ * @param slab copia della porzione del processo
+ */
+static void write_rle(snapshot_writer *writer, int gen, const char *slab) {
+    FILE *out = writer->stream;
+    fprintf(out, "#C generation %d rows %lld-%lld\nx = %lld, y = %d, rule = B3/S23\n", gen,
+            writer->first_row, writer->first_row + writer->rows - 1, writer->cols, writer->rows);
+    for (int i = 0; i < writer->rows; i++) {
+        const char *row = slab + (size_t)i * writer->cols;
+        long long j = 0;
+        while (j < writer->cols) {
+            long long run = 1;
+            while (j + run < writer->cols && row[j + run] == row[j]) {
+                run++;
+            }
+            /* le celle morte a fine riga sono implicite */
+            if (row[j] == ALIVE || j + run < writer->cols) {
+                if (run > 1) {
+                    fprintf(out, "%lld", run);
+                }
+                fputc(row[j] == ALIVE ? 'o' : 'b', out);
+            }
+            j += run;
+        }
+        fputc(i == writer->rows - 1 ? '!' : '$', out);
+    }
+    fputc('\n', out);
+}
+
+/*
+ * @brief Codifica la differenza fra due versioni delle righe compresse
+ * 
+ * Il record è una sequenza di coppie varint (byte invariati da saltare, byte modificati)
+ * seguite dallo XOR dei byte modificati. Una sequenza di byte modificati prosegue oltre
+ * un singolo byte invariato, che costerebbe più di due varint; i byte invariati finali
+ * sono impliciti.
+ * 
+ * @param current righe compresse dello snapshot
+ * @param previous righe compresse dello snapshot precedente, azzerate per un keyframe
+ * @param size byte delle righe compresse
+ * @param out record, almeno 2 * size + 32 byte
+ * @return byte del record
+ */
+static size_t encode_delta(const unsigned char *current, const unsigned char *previous, size_t size, unsigned char *out) {
+    size_t n = 0, i = 0;
+    while (i < size) {
+        size_t start = i;
+        while (i < size && current[i] == previous[i]) {
+            i++;
+        }
+        if (i == size) {
+            break;
+        }
+        size_t first = i;
+        while (i < size && (current[i] != previous[i] || (i + 1 < size && current[i + 1] != previous[i + 1]))) {
+            i++;
+        }
+        n += put_varint(out + n, first - start);
+        n += put_varint(out + n, i - first);
+        for (size_t k = first; k < i; k++) {
+            out[n++] = current[k] ^ previous[k];
+        }
+    }
+    return n;
+}
+
+/*
+ * @brief Accoda uno snapshot al file delta del processo
+ * 
+ * Ogni keyframe_every snapshot viene scritto un keyframe, la differenza rispetto a una
+ * porzione vuota; gli altri sono la differenza rispetto allo snapshot precedente. Ogni
+ * record contiene il tipo (DELTA_KEYFRAME o DELTA_XOR), la generazione e la lunghezza
+ * in varint, seguiti dalla codifica di encode_delta delle righe in formato PBM.
+ * 
+ * @param writer stadio di output del processo
+ * @param gen generazione dello snapshot
+ * @param slab copia della porzione del processo
+ */
+static void write_delta(snapshot_writer *writer, int gen, const char *slab) {
+    size_t size = (size_t)writer->rows * ((writer->cols + 7) / 8);
+    unsigned char header[32];
+    bool keyframe = writer->written % writer->keyframe_every == 0;
+    pack_rows(slab, writer->rows, writer->cols, writer->packed);
+    if (keyframe) {
+        memset(writer->previous, 0, size);
+    }
+    size_t len = encode_delta(writer->packed, writer->previous, size, writer->encoded);
+    int n = 0;
+    header[n++] = keyframe ? DELTA_KEYFRAME : DELTA_XOR;
+    n += put_varint(header + n, gen);
+    n += put_varint(header + n, len);
+    if (fwrite(header, 1, n, writer->stream) != (size_t)n || fwrite(writer->encoded, 1, len, writer->stream) != len) {
+        writer->errors++;
+    }
+    /* l'indice permette di raggiungere il record senza leggere i precedenti */
+    delta_entry entry = { gen, writer->offset };
+    if (fwrite(&entry, sizeof(entry), 1, writer->index) != 1) {
+        writer->errors++;
+    }
+    writer->offset += n + len;
+    writer->raw_bytes += size;
+    writer->encoded_bytes += n + len;
+
+    /* lo snapshot corrente diventa il riferimento del successivo */
+    unsigned char *temp = writer->previous;
+    writer->previous = writer->packed;
+    writer->packed = temp;
+}
+
+/*
+ * @brief Corpo del thread di output: svuota la coda degli snapshot e li scrive
+ * 
+ * Il thread non effettua chiamate MPI, quindi non richiede supporto ai thread oltre
+ * a quello già richiesto. Gli snapshot accumulati vengono scritti tutti insieme
+ * prima di tornare in attesa.
+ * 
+ * @param arg stadio di output del processo
+ */
+static void *snapshot_thread(void *arg) {
+    snapshot_writer *writer = arg;
+    pthread_mutex_lock(&writer->lock);
+    for (;;) {
+        while (writer->count == 0 && !writer->closing) {
+            pthread_cond_wait(&writer->not_empty, &writer->lock);
+        }
+        if (writer->count == 0) {
+            break;
+        }
+        int slot = writer->head;
+        pthread_mutex_unlock(&writer->lock);
+
+        /* la codifica avviene fuori dal lock, il calcolo può accodare altri snapshot */
+        if (writer->format == SNAPSHOT_PBM) {
+            write_pbm(writer, writer->gens[slot], writer->slots[slot]);
+        } else if (writer->format == SNAPSHOT_RLE) {
+            write_rle(writer, writer->gens[slot], writer->slots[slot]);
+        } else {
+            write_delta(writer, writer->gens[slot], writer->slots[slot]);
+        }
+
+        pthread_mutex_lock(&writer->lock);
+        writer->head = (writer->head + 1) % writer->slot_count;
+        writer->count--;
+        writer->written++;
+        pthread_cond_signal(&writer->not_full);
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+/*
+ * @brief Avvia lo stadio di output asincrono di un processo
+ * 
+ * @param writer stadio di output da inizializzare
+ * @param opt opzioni da riga di comando
+ * @param rank rank del processo corrente
+ * @param num_proc numero di processi
+ * @param rows numero di righe della porzione
+ * @param cols numero di colonne della matrice
+ * @param first_row indice globale della prima riga della porzione
+ * @param row_size numero di righe della matrice
+ * @return true se lo stadio è stato avviato
+ */
+bool snapshot_open(snapshot_writer *writer, gol_options *opt, int rank, int num_proc, int rows, long long cols, long long first_row, long long row_size) {
+    memset(writer, 0, sizeof(snapshot_writer));
+    writer->format = opt->snapshot_format;
+    writer->prefix = opt->snapshot_prefix;
+    writer->rank = rank;
+    writer->rows = rows;
+    writer->cols = cols;
+    writer->first_row = first_row;
+    writer->row_size = row_size;
+    writer->slot_count = DEF_SNAPSHOT_SLOTS;
+    writer->slots = malloc(writer->slot_count * sizeof(char *));
+    writer->gens = malloc(writer->slot_count * sizeof(int));
+    for (int s = 0; s < writer->slot_count; s++) {
+        writer->slots[s] = checked_alloc((size_t)rows, cols);
+    }
+    if (writer->format == SNAPSHOT_PBM) {
+        writer->packed = checked_alloc((size_t)rows, (cols + 7) / 8);
+    } else {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s.r%d.%s", writer->prefix, rank, writer->format == SNAPSHOT_RLE ? "rle" : "delta");
+        writer->stream = fopen(path, "w");
+        if (writer->stream == NULL) {
+            return false;
+        }
+        /* buffer ampio: più snapshot vengono scritti con poche write */
+        setvbuf(writer->stream, NULL, _IOFBF, 1 << 22);
+    }
+    if (writer->format == SNAPSHOT_DELTA) {
+        size_t size = (size_t)rows * ((cols + 7) / 8);
+        unsigned char header[64];
+        int n = sizeof(DELTA_MAGIC) - 1;
+        writer->keyframe_every = opt->snapshot_keyframe;
+        writer->packed = checked_alloc(size, 1);
+        writer->previous = checked_alloc(size, 1);
+        writer->encoded = checked_alloc(2 * size + 32, 1);
+        /* intestazione: processi, righe della porzione, colonne e righe della matrice, periodo dei keyframe */
+        memcpy(header, DELTA_MAGIC, n);
+        n += put_varint(header + n, num_proc);
+        n += put_varint(header + n, first_row);
+        n += put_varint(header + n, rows);
+        n += put_varint(header + n, cols);
+        n += put_varint(header + n, row_size);
+        n += put_varint(header + n, writer->keyframe_every);
+        if (fwrite(header, 1, n, writer->stream) != (size_t)n) {
+            writer->errors++;
+        }
+        writer->offset = n;
+
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s.r%d.index", writer->prefix, rank);
+        writer->index = fopen(path, "w");
+        if (writer->index == NULL) {
+            return false;
+        }
+    }
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->not_empty, NULL);
+    pthread_cond_init(&writer->not_full, NULL);
+    pthread_create(&writer->thread, NULL, snapshot_thread, writer);
+    return true;
+}
+
+/*
+ * @brief Copia la porzione corrente in uno slot libero e la accoda al thread di output
+ * 
+ * Il calcolo si blocca solo se tutti gli slot sono occupati, il tempo di attesa
+ * viene accumulato per essere riportato a fine esecuzione.
+ * 
+ * @param writer stadio di output del processo
+ * @param gen generazione della porzione
+ * @param slab porzione del processo
+ */
+void snapshot_push(snapshot_writer *writer, int gen, const char *slab) {
+    pthread_mutex_lock(&writer->lock);
+    if (writer->count == writer->slot_count) {
+        double wait_start = MPI_Wtime();
+        while (writer->count == writer->slot_count) {
+            pthread_cond_wait(&writer->not_full, &writer->lock);
+        }
+        writer->stall_time += MPI_Wtime() - wait_start;
+    }
+    int slot = (writer->head + writer->count) % writer->slot_count;
+    pthread_mutex_unlock(&writer->lock);
+
+    /* lo slot è libero finché non viene accodato, la copia avviene fuori dal lock */
+    memcpy(writer->slots[slot], slab, (size_t)writer->rows * writer->cols);
+    writer->gens[slot] = gen;
+
+    pthread_mutex_lock(&writer->lock);
+    writer->count++;
+    pthread_cond_signal(&writer->not_empty);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+/*
+ * @brief Attende la scrittura degli snapshot in coda e libera lo stadio di output
+ * 
+ * @param writer stadio di output del processo
+ */
+void snapshot_close(snapshot_writer *writer) {
+    pthread_mutex_lock(&writer->lock);
+    writer->closing = true;
+    pthread_cond_signal(&writer->not_empty);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+
+    if (writer->stream != NULL) {
+        fclose(writer->stream);
+    }
+    if (writer->index != NULL) {
+        fclose(writer->index);
+    }
+    for (int s = 0; s < writer->slot_count; s++) {
+        free(writer->slots[s]);
+    }
+    free(writer->slots);
+    free(writer->gens);
+    free(writer->packed);
+    free(writer->previous);
+    free(writer->encoded);
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->not_empty);
+    pthread_cond_destroy(&writer->not_full);
+}
@@ -0,0 +1,179 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Statistiche per generazione, riduzione fra i processi e riconoscimento dei cicli
+ * Francesco Pio Covino
+ */
+#include <limits.h>
+
+#include "gol_engine.h"
+
+/*
+ * @brief Aggiorna le statistiche della generazione con lo stato di una cella
+ * 
+ * @param stats statistiche da aggiornare, NULL se disabilitate
+ * @param before stato della cella nella generazione precedente
+ * @param after stato della cella nella nuova generazione
+ * @param row indice globale della riga della cella
+ * @param col indice della colonna della cella
+ */
+static inline void record_cell(gen_stats *stats, char before, char after, long long row, long long col) {
+    if (stats == NULL) {
+        return;
+    }
+    if (after == ALIVE) {
+        stats->live++;
+        if (before == DEAD) {
+            stats->births++;
+        }
+        if (row < stats->min_row) { stats->min_row = row; }
+        if (row > stats->max_row) { stats->max_row = row; }
+        if (col < stats->min_col) { stats->min_col = col; }
+        if (col > stats->max_col) { stats->max_col = col; }
+        stats->hash += mix64(mix64(row) ^ col);
+    } else if (before == ALIVE) {
+        stats->deaths++;
+    }
+}
+
+/*
+ * @brief Aggiorna le statistiche con una riga appena calcolata
+ * 
+ * @param before riga nella generazione precedente
+ * @param after riga nella nuova generazione
+ * @param cols numero di colonne della matrice
+ * @param row indice globale della riga
+ * @param stats statistiche da aggiornare
+ */
+void row_stats(const char *before, const char *after, long long cols, long long row, gen_stats *stats) {
+    for (long long j = 0; j < cols; j++) {
+        record_cell(stats, before[j], after[j], row, j);
+    }
+}
+
+/*
+ * @brief Azzera le statistiche di una generazione
+ * 
+ * @param stats statistiche da azzerare
+ */
+void reset_stats(gen_stats *stats) {
+    stats->live = stats->births = stats->deaths = 0;
+    /* bounding box vuoto: i minimi partono dal massimo e viceversa */
+    stats->min_row = stats->min_col = LLONG_MAX;
+    stats->max_row = stats->max_col = -1;
+    stats->hash = 0;
+}
+
+/*
+ * @brief Calcola le statistiche di una porzione senza avanzare di generazione
+ * 
+ * Usata per la generazione iniziale, le nascite e le morti restano a zero.
+ * 
+ * @param buffer porzione del processo
+ * @param rows numero di righe della porzione
+ * @param cols numero di colonne della matrice
+ * @param first_row indice globale della prima riga della porzione
+ * @param stats statistiche da calcolare
+ */
+void slab_stats(char *buffer, int rows, long long cols, long long first_row, gen_stats *stats) {
+    reset_stats(stats);
+    for (int i = 0; i < rows; i++) {
+        for (long long j = 0; j < cols; j++) {
+            record_cell(stats, ALIVE, buffer[(size_t)i * cols + j], first_row + i, j);
+        }
+    }
+}
+
+/*
+ * @brief Inserisce lo stato globale di una generazione nella finestra e controlla se si ripete
+ * 
+ * Ogni processo riceve gli stessi valori dalla riduzione, quindi tutti prendono
+ * la stessa decisione senza ulteriori comunicazioni.
+ * 
+ * @param window finestra delle ultime generazioni
+ * @param live celle vive nella generazione
+ * @param hash hash globale della generazione
+ * @return CYCLE_EXTINCTION, il periodo k se la generazione coincide con quella di k passi prima, altrimenti CYCLE_NONE
+ */
+int check_cycle(cycle_window *window, unsigned long long live, uint64_t hash) {
+    int size = window->period + 1;
+    int found = CYCLE_NONE;
+    if (live == 0) {
+        found = CYCLE_EXTINCTION;
+    } else {
+        for (int k = 1; k <= window->period && k <= window->seen; k++) {
+            if (window->hashes[(window->seen - k) % size] == hash) {
+                found = k;
+                break;
+            }
+        }
+    }
+    window->hashes[window->seen % size] = hash;
+    window->seen++;
+    return found;
+}
+
+/*
+ * @brief Avvia la riduzione non bloccante delle statistiche locali di una generazione
+ * 
+ * La riduzione viene completata da finish_stats durante la generazione successiva,
+ * sovrapponendo la comunicazione al calcolo.
+ * 
+ * @param red riduzione da avviare, non deve essere in corso
+ * @param local statistiche calcolate dal processo corrente
+ * @param gen generazione a cui si riferiscono le statistiche
+ */
+void start_stats(stats_reduction *red, gen_stats *local, int gen) {
+    red->counters[0] = local->live;
+    red->counters[1] = local->births;
+    red->counters[2] = local->deaths;
+    red->counters[3] = local->hash;
+    /* i massimi sono negati per calcolare tutto il bounding box con MPI_MIN */
+    red->bounds[0] = local->min_row;
+    red->bounds[1] = local->min_col;
+    red->bounds[2] = -local->max_row;
+    red->bounds[3] = -local->max_col;
+    red->gen = gen;
+    red->pending = true;
+    MPI_Iallreduce(red->counters, red->counters_out, 4, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD, &red->requests[0]);
+    MPI_Iallreduce(red->bounds, red->bounds_out, 4, MPI_LONG_LONG, MPI_MIN, MPI_COMM_WORLD, &red->requests[1]);
+}
+
+/*
+ * @brief Scrive la riga di statistiche di una generazione
+ * 
+ * @param out file su cui scrivere
+ * @param gen generazione a cui si riferiscono le statistiche
+ * @param live celle vive
+ * @param births celle nate
+ * @param deaths celle morte
+ * @param bounds bounding box delle celle vive: min_row, min_col, max_row, max_col
+ */
+void print_stats(FILE *out, int gen, unsigned long long live, unsigned long long births, unsigned long long deaths,
+                 const long long *bounds) {
+    if (live > 0) {
+        fprintf(out, "%d %llu %llu %llu %lld %lld %lld %lld\n", gen, live, births, deaths,
+                bounds[0], bounds[1], bounds[2], bounds[3]);
+    } else {
+        /* nessuna cella viva: bounding box vuoto */
+        fprintf(out, "%d 0 %llu %llu - - - -\n", gen, births, deaths);
+    }
+}
+
+/*
+ * @brief Completa la riduzione in corso e ne scrive il risultato
+ * 
+ * @param red riduzione da completare, se non è in corso non viene fatto nulla
+ * @param out file su cui scrivere la riga della generazione, NULL per non scrivere
+ */
+void finish_stats(stats_reduction *red, FILE *out) {
+    if (!red->pending) {
+        return;
+    }
+    MPI_Waitall(2, red->requests, MPI_STATUSES_IGNORE);
+    red->pending = false;
+    if (out != NULL) {
+        long long bounds[4] = { red->origin[0] + red->bounds_out[0], red->origin[1] + red->bounds_out[1],
+                                red->origin[0] - red->bounds_out[2], red->origin[1] - red->bounds_out[3] };
+        print_stats(out, red->gen, red->counters_out[0], red->counters_out[1], red->counters_out[2], bounds);
+    }
+}
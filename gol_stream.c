@@ -0,0 +1,242 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Calcolo fuori memoria: righe interne per bande su una porzione mappata da file
+ * Francesco Pio Covino
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "gol_engine.h"
+
+/*
+* @brief Pagine del file che contengono le righe [first, last) di un buffer
+*
+* Le righe vengono limitate a quelle del buffer, righe fantasma comprese. Con inner
+* si considerano solo le pagine interamente contenute nelle righe, che possono essere
+* rilasciate senza toccare le righe vicine; altrimenti tutte le pagine toccate.
+*
+* @param stream calcolo per bande
+* @param buffer prima riga posseduta del buffer
+* @param first prima riga
+* @param last riga successiva all'ultima
+* @param inner solo le pagine interne
+* @param offset posizione della prima pagina nel file
+* @param len byte delle pagine
+* @return false se l'intervallo non contiene pagine
+*/
+static bool row_pages(const band_stream *stream, const char *buffer, int first, int last, bool inner,
+                      size_t *offset, size_t *len) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (first < -stream->depth) {
+        first = -stream->depth;
+    }
+    if (last > stream->rows + stream->depth) {
+        last = stream->rows + stream->depth;
+    }
+    if (last <= first) {
+        return false;
+    }
+    size_t start = (size_t)(buffer - stream->arena->base) + (ptrdiff_t)first * stream->cols;
+    size_t end = (size_t)(buffer - stream->arena->base) + (ptrdiff_t)last * stream->cols;
+    if (inner) {
+        start = (start + page - 1) / page * page;
+        end = end / page * page;
+    } else {
+        start = start / page * page;
+        end = (end + page - 1) / page * page;
+    }
+    if (end <= start) {
+        return false;
+    }
+    *offset = start;
+    *len = end - start;
+    return true;
+}
+
+/*
+* @brief Rilascia le righe [first, last) di un buffer, dopo averne completato la scrittura
+*
+* @param stream calcolo per bande
+* @param buffer prima riga posseduta del buffer
+* @param first prima riga
+* @param last riga successiva all'ultima
+*/
+static void release_rows(band_stream *stream, const char *buffer, int first, int last) {
+    size_t offset, len;
+    if (!row_pages(stream, buffer, first, last, true, &offset, &len)) {
+        return;
+    }
+    double start = MPI_Wtime();
+    sync_file_range(stream->arena->fd, (off_t)offset, (off_t)len,
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    stream->wait_time += MPI_Wtime() - start;
+    madvise(stream->arena->base + offset, len, MADV_DONTNEED);
+    posix_fadvise(stream->arena->fd, (off_t)offset, (off_t)len, POSIX_FADV_DONTNEED);
+}
+
+/*
+* @brief Chiude una banda: avvia la scrittura dei suoi risultati e rilascia quanto non serve più
+*
+* La scrittura della banda resta in corso durante il calcolo della successiva: si attende
+* solo quella della banda precedente, prima di rilasciarla. Le righe di partenza a più di
+* depth righe dalla banda successiva non vengono più lette in questa generazione.
+*
+* @param stream calcolo per bande
+* @param lo prima riga della banda
+* @param hi riga successiva all'ultima della banda
+*/
+static void band_done(band_stream *stream, int lo, int hi) {
+    size_t offset, len;
+    if (row_pages(stream, stream->result, lo, hi, false, &offset, &len)) {
+        sync_file_range(stream->arena->fd, (off_t)offset, (off_t)len, SYNC_FILE_RANGE_WRITE);
+    }
+    stream->written += (long long)(hi - lo) * stream->cols;
+    if (stream->pending_lo < stream->pending_hi) {
+        release_rows(stream, stream->result, stream->pending_lo, stream->pending_hi);
+    }
+    stream->pending_lo = lo;
+    stream->pending_hi = hi;
+
+    /* durante l'inizializzazione non c'è un buffer di partenza */
+    if (stream->origin != NULL &&
+        row_pages(stream, stream->origin, stream->released, hi - stream->depth, true, &offset, &len)) {
+        madvise(stream->arena->base + offset, len, MADV_DONTNEED);
+        posix_fadvise(stream->arena->fd, (off_t)offset, (off_t)len, POSIX_FADV_DONTNEED);
+    }
+    stream->released = hi - stream->depth;
+}
+
+/*
+* @brief Chiede al kernel di leggere in anticipo le righe di partenza di una banda
+*
+* @param stream calcolo per bande
+* @param lo prima riga della banda
+* @param hi riga successiva all'ultima della banda
+*/
+static void band_readahead(band_stream *stream, int lo, int hi) {
+    size_t offset, len;
+    if (row_pages(stream, stream->origin, lo - stream->depth, hi + stream->depth, false, &offset, &len)) {
+        madvise(stream->arena->base + offset, len, MADV_WILLNEED);
+    }
+}
+
+/*
+* @brief Prepara il calcolo per bande di una porzione su file
+*
+* @param stream calcolo da preparare
+* @param arena arena mappata con arena_open_file
+* @param band_rows righe interne di una banda
+* @param rows righe possedute
+* @param cols colonne della matrice
+* @param depth righe fantasma per lato
+*/
+void stream_open(band_stream *stream, const grid_arena *arena, int band_rows, int rows, long long cols, int depth) {
+    memset(stream, 0, sizeof(band_stream));
+    stream->arena = arena;
+    stream->band_rows = band_rows;
+    stream->rows = rows;
+    stream->cols = cols;
+    stream->depth = depth;
+}
+
+/*
+* @brief Inizia il calcolo per bande delle righe interne di una generazione
+*
+* L'ultima banda della generazione precedente è ancora in scrittura: viene rilasciata
+* qui, così la sua scrittura avanza durante le righe di bordo e lo scambio.
+*
+* @param stream calcolo per bande
+* @param origin prima riga posseduta del buffer da cui prendere i dati
+* @param result prima riga posseduta del buffer su cui memorizzare i risultati
+* @param first prima riga interna
+* @param end riga successiva all'ultima riga interna
+*/
+void stream_begin(band_stream *stream, char *origin, char *result, int first, int end) {
+    if (stream->pending_lo < stream->pending_hi) {
+        release_rows(stream, stream->result, stream->pending_lo, stream->pending_hi);
+    }
+    stream->origin = origin;
+    stream->result = result;
+    stream->band = first;
+    stream->end = end;
+    stream->pending_lo = stream->pending_hi = 0;
+    stream->released = -stream->depth;
+    band_readahead(stream, first, first + stream->band_rows);
+}
+
+/*
+* @brief Calcola righe interne consecutive, chiudendo le bande completate
+*
+* Le righe vengono passate in ordine, anche a blocchi più piccoli di una banda
+* (--progress=test). All'inizio di ogni banda viene anticipata la lettura della successiva.
+*
+* @param stream calcolo per bande avviato con stream_begin
+* @param kernel kernel di calcolo
+* @param first prima riga da calcolare
+* @param last riga successiva all'ultima da calcolare
+* @param first_row indice globale della prima riga posseduta, per le statistiche
+* @param stats statistiche da aggiornare, NULL se disabilitate
+*/
+void stream_rows(band_stream *stream, const gol_kernel *kernel, int first, int last, long long first_row, gen_stats *stats) {
+    for (int i = first; i < last;) {
+        int band_end = stream->end - stream->band > stream->band_rows ? stream->band + stream->band_rows : stream->end;
+        int stop = last < band_end ? last : band_end;
+        if (i == stream->band) {
+            band_readahead(stream, band_end, band_end + stream->band_rows);
+        }
+        compute_rows(kernel, stream->origin, stream->result, i, stop, stream->cols, first_row, stats);
+        i = stop;
+        if (stop == band_end) {
+            band_done(stream, stream->band, band_end);
+            stream->band = band_end;
+        }
+    }
+}
+
+/*
+* @brief Inizializza la porzione su file per bande, rilasciando ogni banda già scritta
+*
+* Il seed casuale dipende solo dall'indice globale di ogni cella, quindi viene generato
+* una banda alla volta; i seed da pattern vengono generati sull'intera porzione.
+*
+* @param stream calcolo per bande
+* @param seed impostazioni di generazione del seed
+* @param buffer prima riga posseduta del buffer da inizializzare
+* @param first_row indice globale della prima riga posseduta
+* @param row_size righe della matrice
+* @return false se il pattern non esiste
+*/
+bool stream_seed(band_stream *stream, seed_options *seed, char *buffer, long long first_row, long long row_size) {
+    if (seed->mode != SEED_RANDOM) {
+        return seed_slab(seed, buffer, first_row, stream->rows, row_size, stream->cols);
+    }
+    stream->origin = NULL;
+    stream->result = buffer;
+    stream->pending_lo = stream->pending_hi = 0;
+    for (int i = 0; i < stream->rows; i += stream->band_rows) {
+        int count = stream->rows - i < stream->band_rows ? stream->rows - i : stream->band_rows;
+        seed_slab(seed, buffer + (size_t)i * stream->cols, first_row + i, count, row_size, stream->cols);
+        /* la scrittura della banda avanza mentre si genera la successiva */
+        band_done(stream, i, i + count);
+    }
+    /* il volume riportato riguarda solo le generazioni */
+    stream->written = 0;
+    return true;
+}
+
+/*
+* @brief Scrive sul file e rilascia un intero buffer, righe fantasma comprese
+*
+* Usata dopo l'inizializzazione, che scrive tutta la porzione prima della prima generazione.
+*
+* @param stream calcolo per bande
+* @param buffer prima riga posseduta del buffer
+*/
+void stream_release(band_stream *stream, char *buffer) {
+    release_rows(stream, buffer, -stream->depth, stream->rows + stream->depth);
+}
@@ -0,0 +1,154 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Posizione dei processi nell'anello secondo la topologia di nodi e socket
+ * Francesco Pio Covino
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sched.h>
+
+#include "gol_engine.h"
+
+/*
+* @brief Socket fisico della CPU su cui gira il processo, letto da sysfs
+*
+* @return physical_package_id della CPU corrente, -1 se non disponibile
+*/
+static int current_socket(void) {
+    char path[128];
+    int cpu = sched_getcpu(), socket = -1;
+    FILE *file;
+    if (cpu < 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    if (fscanf(file, "%d", &socket) != 1) {
+        socket = -1;
+    }
+    fclose(file);
+    return socket;
+}
+
+/* posizione di un processo: nodo, socket e rank, in ordine di confronto */
+typedef struct {
+    int node, socket, rank;
+} rank_place;
+
+/*
+* @brief Ordina i processi per nodo, poi per socket, poi per rank
+*/
+static int compare_places(const void *a, const void *b) {
+    const rank_place *x = a, *y = b;
+    if (x->node != y->node) {
+        return x->node < y->node ? -1 : 1;
+    }
+    if (x->socket != y->socket) {
+        return x->socket < y->socket ? -1 : 1;
+    }
+    return (x->rank > y->rank) - (x->rank < y->rank);
+}
+
+/*
+* @brief Conta gli archi dell'anello che collegano nodi o socket diversi
+*
+* @param places nodo e socket di ogni rank
+* @param order rank in ogni posizione dell'anello
+* @param num_proc numero di processi
+* @param cross_node archi fra nodi diversi
+* @param cross_socket archi fra socket diversi, anche sullo stesso nodo
+*/
+static void count_edges(const rank_place *places, const int *order, int num_proc, int *cross_node, int *cross_socket) {
+    *cross_node = *cross_socket = 0;
+    /* con un solo processo l'anello non ha archi verso altri processi */
+    if (num_proc < 2) {
+        return;
+    }
+    for (int i = 0; i < num_proc; i++) {
+        const rank_place *a = &places[order[i]], *b = &places[order[(i + 1) % num_proc]];
+        if (a->node != b->node) {
+            (*cross_node)++;
+            (*cross_socket)++;
+        } else if (a->socket != b->socket) {
+            (*cross_socket)++;
+        }
+    }
+}
+
+/*
+* @brief Sceglie la posizione di ogni processo nell'anello delle righe
+*
+* Ogni processo ricava il proprio nodo dal communicator dei processi che condividono
+* la memoria (MPI_COMM_TYPE_SHARED, identificato dal rank minimo) e il proprio socket
+* da sysfs. Con topology i processi dello stesso socket, poi dello stesso nodo, vengono
+* messi in posizioni consecutive: l'anello attraversa ogni nodo e ogni socket una sola
+* volta, quindi quasi tutto lo scambio delle righe di bordo resta nello stesso socket.
+* Senza topology la posizione coincide con il rank.
+*
+* @param place posizione da calcolare
+* @param comm communicator dei processi dell'anello
+* @param topology riordina l'anello secondo nodi e socket
+*/
+void placement_open(ring_placement *place, MPI_Comm comm, bool topology) {
+    MPI_Comm node;
+    int rank, num_proc, mine[3];
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_proc);
+    rank_place *places = checked_alloc(num_proc, sizeof(rank_place));
+
+    memset(place, 0, sizeof(ring_placement));
+    place->comm = comm;
+    place->order = checked_alloc(num_proc, sizeof(int));
+    place->position = checked_alloc(num_proc, sizeof(int));
+
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    mine[0] = rank;
+    MPI_Bcast(&mine[0], 1, MPI_INT, 0, node);
+    MPI_Comm_free(&node);
+    mine[1] = current_socket();
+    mine[2] = rank;
+    MPI_Allgather(mine, 3, MPI_INT, places, 3, MPI_INT, comm);
+
+    for (int i = 0; i < num_proc; i++) {
+        place->order[i] = i;
+        if (places[i].rank == places[i].node) {
+            place->nodes++;
+        }
+    }
+    /* socket distinti, contando separatamente quelli di nodi diversi */
+    rank_place *sorted = checked_alloc(num_proc, sizeof(rank_place));
+    memcpy(sorted, places, num_proc * sizeof(rank_place));
+    qsort(sorted, num_proc, sizeof(rank_place), compare_places);
+    for (int i = 0; i < num_proc; i++) {
+        if (i == 0 || sorted[i].node != sorted[i - 1].node || sorted[i].socket != sorted[i - 1].socket) {
+            place->sockets++;
+        }
+    }
+    count_edges(places, place->order, num_proc, &place->cross_node[0], &place->cross_socket[0]);
+    if (topology) {
+        for (int i = 0; i < num_proc; i++) {
+            place->order[i] = sorted[i].rank;
+        }
+    }
+    count_edges(places, place->order, num_proc, &place->cross_node[1], &place->cross_socket[1]);
+    for (int i = 0; i < num_proc; i++) {
+        place->position[place->order[i]] = i;
+    }
+    free(sorted);
+    free(places);
+}
+
+/*
+* @brief Libera le posizioni dei processi
+*
+* @param place posizioni da liberare
+*/
+void placement_close(ring_placement *place) {
+    free(place->order);
+    free(place->position);
+}
@@ -0,0 +1,276 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Autotuning: scelta di kernel, scambio delle righe di bordo e avanzamento con prove brevi sulla porzione iniziale
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gol_engine.h"
+
+static const char *progress_names[] = { "none", "test", "thread" };
+
+/*
+* @brief Chiave del file di tuning: impronta della macchina e dimensioni del problema
+*
+* L'impronta combina il modello della CPU letto da /proc/cpuinfo, le CPU disponibili
+* e i nodi occupati dai processi; il problema è descritto da dimensioni della matrice,
+* numero di processi e regola, che determina i kernel utilizzabili.
+*
+* @param key buffer della chiave
+* @param size dimensione del buffer
+* @param opt opzioni da riga di comando
+* @param nodes nodi occupati dai processi
+* @param num_proc numero di processi
+* @param row_size righe della matrice
+* @param col_size colonne della matrice
+*/
+static void tune_key(char *key, size_t size, const gol_options *opt, int nodes, int num_proc, long long row_size,
+                     long long col_size) {
+    char line[256], model[256] = "unknown";
+    FILE *info = fopen("/proc/cpuinfo", "r");
+    if (info != NULL) {
+        while (fgets(line, sizeof(line), info) != NULL) {
+            if (strncmp(line, "model name", 10) == 0) {
+                snprintf(model, sizeof(model), "%s", line);
+                break;
+            }
+        }
+        fclose(info);
+    }
+    uint64_t fingerprint = mix64((uint64_t)sysconf(_SC_NPROCESSORS_ONLN) ^ ((uint64_t)nodes << 32));
+    for (const char *c = model; *c != '\0'; c++) {
+        fingerprint = mix64(fingerprint ^ (unsigned char)*c);
+    }
+    snprintf(key, size, "%016llx %lld %lld %d %s", (unsigned long long)fingerprint, row_size, col_size, num_proc,
+             opt->ltl != NULL ? opt->ltl : "B3/S23");
+}
+
+/*
+* @brief Cerca nel file di tuning la configurazione di una chiave
+*
+* Vale l'ultima riga con la chiave, così una nuova misura sostituisce le precedenti.
+*
+* @param path file di tuning
+* @param key chiave cercata
+* @param choice configurazione letta
+* @return true se la chiave è presente
+*/
+static bool read_tuning(const char *path, const char *key, tune_choice *choice) {
+    char line[512], progress[16];
+    size_t key_len = strlen(key);
+    bool found = false;
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        tune_choice entry = { .trials = 0 };
+        if (line[0] == '#' || strncmp(line, key, key_len) != 0 || line[key_len] != ' ') {
+            continue;
+        }
+        if (sscanf(line + key_len, "%15s %15s %15s %d %lf", entry.kernel, entry.halo, progress,
+                   &entry.progress_rows, &entry.seconds) != 5 || entry.progress_rows < 1) {
+            continue;
+        }
+        for (int m = PROGRESS_NONE; m <= PROGRESS_THREAD; m++) {
+            if (strcmp(progress, progress_names[m]) == 0) {
+                entry.progress = m;
+                *choice = entry;
+                found = true;
+            }
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+/*
+* @brief Misura una configurazione sulla porzione iniziale
+*
+* La prova usa un'arena e uno scambio propri, con lo stesso ciclo del programma principale
+* senza statistiche: la prima generazione scalda cache e pagine, le successive TUNE_GENERATIONS
+* vengono misurate. Il risultato è il tempo del processo più lento, uguale su tutti i processi.
+*
+* @param main scambio del programma principale, da cui prendere porzione e anello
+* @param rows_for_proc righe assegnate ad ogni processo
+* @param slab prima riga posseduta della porzione iniziale
+* @param kernel kernel di calcolo
+* @param backend backend di scambio delle righe di bordo
+* @param mode una delle modalità PROGRESS_*
+* @param progress_rows righe interne fra due chiamate di avanzamento
+* @return secondi per generazione, negativo se il backend non è disponibile
+*/
+static double run_trial(const halo_exchange *main, int *rows_for_proc, const char *slab, const gol_kernel *kernel,
+                        const halo_backend *backend, int mode, int progress_rows) {
+    grid_arena arena;
+    halo_exchange halo;
+    halo_progress progress;
+    int rows = main->rows, depth = main->depth, num_proc;
+    long long cols = main->cols;
+    size_t slab_bytes = ((size_t)rows + 2 * depth) * cols;
+
+    MPI_Comm_size(main->comm, &num_proc);
+    if (!arena_open(&arena, 2 * (slab_bytes + ARENA_ALIGN), false)) {
+        fprintf(stderr, "Error, cannot map %zu bytes on rank %d.\n", 2 * slab_bytes, main->rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (!halo_open(&halo, backend, &arena, main->row_data, main->rank, num_proc, main->place, rows_for_proc, cols, depth)) {
+        arena_close(&arena);
+        return -1;
+    }
+    char *current = halo.buffers[0], *next = halo.buffers[1], *temp;
+    memcpy(current, slab, (size_t)rows * cols);
+    backend->start(&halo, current);
+    backend->finish(&halo);
+    progress_open(&progress, &halo, backend->overlap ? mode : PROGRESS_NONE, progress_rows);
+
+    double start = 0;
+    for (int gen = 0; gen <= TUNE_GENERATIONS; gen++) {
+        if (gen == 1) {
+            MPI_Barrier(main->comm);
+            start = MPI_Wtime();
+        }
+        compute_rows(kernel, current, next, 0, depth, cols, 0, NULL);
+        if (rows > depth) {
+            compute_rows(kernel, current, next, rows - depth > depth ? rows - depth : depth, rows, cols, 0, NULL);
+        }
+        backend->start(&halo, next);
+        progress_compute(&progress, &halo, kernel, current, next, 0, NULL);
+        progress_wait(&progress, &halo);
+        temp = current;
+        current = next;
+        next = temp;
+    }
+    double elapsed = (MPI_Wtime() - start) / TUNE_GENERATIONS, slowest;
+    MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, main->comm);
+
+    progress_close(&progress);
+    halo_close(&halo);
+    arena_close(&arena);
+    return slowest;
+}
+
+/*
+* @brief Prova una configurazione e la mantiene se è la più veloce finora
+*
+* @param best configurazione più veloce finora, aggiornata
+* @param main scambio del programma principale
+* @param rows_for_proc righe assegnate ad ogni processo
+* @param slab prima riga posseduta della porzione iniziale
+* @param kernel kernel di calcolo, con la sua regola
+* @param halo nome del backend di scambio
+* @param mode una delle modalità PROGRESS_*
+* @param progress_rows righe interne fra due chiamate di avanzamento
+* @return true se la configurazione è stata scelta
+*/
+static bool try_config(tune_choice *best, const halo_exchange *main, int *rows_for_proc, const char *slab,
+                       const gol_kernel *kernel, const char *halo, int mode, int progress_rows) {
+    double seconds = run_trial(main, rows_for_proc, slab, kernel, find_halo(halo), mode, progress_rows);
+    if (seconds < 0) {
+        return false;
+    }
+    best->trials++;
+    if (best->trials > 1 && seconds >= best->seconds) {
+        return false;
+    }
+    snprintf(best->kernel, sizeof(best->kernel), "%s", kernel->name);
+    snprintf(best->halo, sizeof(best->halo), "%s", halo);
+    best->progress = mode;
+    best->progress_rows = progress_rows;
+    best->seconds = seconds;
+    return true;
+}
+
+/*
+* @brief Sceglie kernel, backend di scambio e avanzamento per il problema e la macchina correnti
+*
+* Operazione collettiva. MASTER cerca la configurazione nel file di tuning con la chiave
+* di tune_key; se manca, tutti i processi eseguono prove brevi sulla porzione iniziale.
+* Provare tutte le combinazioni costerebbe troppo su matrici grandi, quindi la ricerca
+* procede per dimensione, fissando ogni volta la migliore trovata: prima il kernel con ring
+* e senza avanzamento, poi il backend, infine avanzamento e righe fra due chiamate.
+* Lo spazio di ricerca è ridotto a questi parametri: i kernel calcolano righe intere
+* senza blocchi di colonne, le righe fantasma sono fissate dal raggio del kernel, le
+* bande esistono solo con --out-of-core, che non si combina con l'autotuning, e il
+* motore a porzioni calcola con un solo thread per processo (--threads vale per ensemble).
+* MASTER aggiunge la scelta al file, così le esecuzioni successive partono da quella.
+*
+* @param choice configurazione scelta, uguale su tutti i processi
+* @param opt opzioni da riga di comando
+* @param rule regola Larger than Life del kernel ltl
+* @param halo scambio del programma principale, aperto sulla porzione iniziale
+* @param rows_for_proc righe assegnate ad ogni processo
+* @param row_size righe della matrice
+* @param slab prima riga posseduta della porzione iniziale
+* @param thread_level livello di supporto ai thread fornito da MPI
+*/
+void autotune(tune_choice *choice, const gol_options *opt, const ltl_rule *rule, const halo_exchange *halo, int *rows_for_proc,
+              long long row_size, const char *slab, int thread_level) {
+    static const char *kernels[] = { "scalar", "simd", "lut", "packed" };
+    static const char *backends[] = { "ring", "rma", "shm", "compact" };
+    char key[384];
+    int num_proc, found = 0;
+
+    MPI_Comm_size(halo->comm, &num_proc);
+    memset(choice, 0, sizeof(tune_choice));
+    if (halo->rank == MASTER) {
+        tune_key(key, sizeof(key), opt, halo->place->nodes, num_proc, row_size, halo->cols);
+        found = read_tuning(opt->autotune, key, choice);
+        /* una voce con nomi non più validi viene misurata di nuovo */
+        if (found && (find_kernel(choice->kernel) == NULL || find_halo(choice->halo) == NULL ||
+                      (opt->ltl != NULL) != (strcmp(choice->kernel, "ltl") == 0))) {
+            found = 0;
+        }
+    }
+    MPI_Bcast(&found, 1, MPI_INT, MASTER, halo->comm);
+    if (found) {
+        MPI_Bcast(choice, sizeof(tune_choice), MPI_BYTE, MASTER, halo->comm);
+        return;
+    }
+
+    /* i kernel per B3/S23 sono intercambiabili, una regola Larger than Life ammette solo ltl */
+    gol_kernel kernel;
+    if (opt->ltl != NULL) {
+        bind_kernel(&kernel, "ltl", rule);
+        try_config(choice, halo, rows_for_proc, slab, &kernel, "ring", PROGRESS_NONE, DEF_PROGRESS_ROWS);
+        unbind_kernel(&kernel);
+    } else {
+        for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+            bind_kernel(&kernel, kernels[k], rule);
+            try_config(choice, halo, rows_for_proc, slab, &kernel, "ring", PROGRESS_NONE, DEF_PROGRESS_ROWS);
+            unbind_kernel(&kernel);
+        }
+    }
+    bind_kernel(&kernel, choice->kernel, rule);
+    for (size_t b = 1; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        try_config(choice, halo, rows_for_proc, slab, &kernel, backends[b], PROGRESS_NONE, DEF_PROGRESS_ROWS);
+    }
+    /* l'avanzamento conta solo se lo scambio resta in corso durante il calcolo */
+    char backend[16];
+    snprintf(backend, sizeof(backend), "%s", choice->halo);
+    if (find_halo(backend)->overlap) {
+        for (int rows = DEF_PROGRESS_ROWS; rows <= 4 * DEF_PROGRESS_ROWS; rows *= 4) {
+            try_config(choice, halo, rows_for_proc, slab, &kernel, backend, PROGRESS_TEST, rows);
+        }
+        if (thread_level >= MPI_THREAD_MULTIPLE) {
+            try_config(choice, halo, rows_for_proc, slab, &kernel, backend, PROGRESS_THREAD, DEF_PROGRESS_ROWS);
+        }
+    }
+    unbind_kernel(&kernel);
+
+    if (halo->rank == MASTER) {
+        FILE *file = fopen(opt->autotune, "a");
+        if (file == NULL) {
+            printf("Warning, cannot write tuning file %s.\n", opt->autotune);
+        } else {
+            if (ftell(file) == 0) {
+                fprintf(file, "# fingerprint rows cols processes rule kernel halo progress progress_rows seconds\n");
+            }
+            fprintf(file, "%s %s %s %s %d %.9f\n", key, choice->kernel, choice->halo, progress_names[choice->progress],
+                    choice->progress_rows, choice->seconds);
+            fclose(file);
+        }
+    }
+}
@@ -0,0 +1,220 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Piano illimitato: finestra che segue le celle vive e ridistribuzione delle righe fra i processi
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "gol_engine.h"
+
+/*
+* @brief Prepara la finestra iniziale, posta nell'origine del piano
+*
+* La finestra viene simulata sul toroide dei kernel e dei backend di scambio:
+* finché le sue prime e ultime 2r righe e colonne sono morte, con r raggio del
+* vicinato, nessuna cella viva vede le celle dal lato opposto e l'evoluzione
+* coincide con quella del piano.
+*
+* @param domain finestra da preparare
+* @param rows righe della matrice iniziale
+* @param cols colonne della matrice iniziale
+* @param radius raggio del vicinato del kernel
+*/
+void unbounded_open(unbounded_domain *domain, long long rows, long long cols, int radius) {
+    memset(domain, 0, sizeof(unbounded_domain));
+    domain->rows = rows;
+    domain->cols = cols;
+    domain->radius = radius;
+    domain->max_cells = rows * cols;
+}
+
+/*
+* @brief Riduce in modo bloccante le celle vive e il bounding box delle statistiche locali
+*
+* Usata solo sulla generazione iniziale, le successive usano la riduzione non bloccante.
+*
+* @param stats statistiche locali
+* @param live celle vive di tutti i processi
+* @param bounds bounding box globale: min_row, min_col, max_row, max_col
+*/
+void unbounded_bounds(gen_stats *stats, unsigned long long *live, long long *bounds) {
+    unsigned long long local_live = stats->live;
+    long long local[4] = { stats->min_row, stats->min_col, -stats->max_row, -stats->max_col };
+    MPI_Allreduce(&local_live, live, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(local, bounds, 4, MPI_LONG_LONG, MPI_MIN, MPI_COMM_WORLD);
+    bounds[2] = -bounds[2];
+    bounds[3] = -bounds[3];
+}
+
+/*
+* @brief Decide se la finestra deve seguire le celle vive
+*
+* Il bounding box arriva dalla riduzione della generazione precedente a quella
+* appena calcolata, che può essersi allargata di r celle: con un margine di
+* UNBOUNDED_MARGIN * r celle la generazione successiva viene ancora calcolata con
+* i bordi morti. La finestra viene anche ridotta quando le celle vive occupano
+* molto meno della sua area. La nuova finestra contiene il bounding box con un
+* bordo di UNBOUNDED_PAD * r celle più un quarto delle sue dimensioni, e ha almeno
+* r righe per processo.
+*
+* @param domain finestra corrente
+* @param live celle vive della generazione
+* @param bounds bounding box della generazione nella finestra: min_row, min_col, max_row, max_col
+* @param num_proc numero di processi
+* @return true se la finestra deve essere ridimensionata con unbounded_resize
+*/
+bool unbounded_fit(unbounded_domain *domain, unsigned long long live, const long long *bounds, int num_proc) {
+    if (live == 0) {
+        return false;
+    }
+    long long margin = (long long)UNBOUNDED_MARGIN * domain->radius, min_rows = (long long)num_proc * domain->radius;
+    long long height = bounds[2] - bounds[0] + 1, width = bounds[3] - bounds[1] + 1;
+    long long pad_rows = (long long)UNBOUNDED_PAD * domain->radius + height / 4;
+    long long pad_cols = (long long)UNBOUNDED_PAD * domain->radius + width / 4;
+    if (height + 2 * pad_rows < min_rows) {
+        pad_rows = (min_rows - height + 1) / 2;
+    }
+    long long rows = height + 2 * pad_rows, cols = width + 2 * pad_cols;
+
+    bool near = bounds[0] < margin || bounds[1] < margin ||
+                domain->rows - 1 - bounds[2] < margin || domain->cols - 1 - bounds[3] < margin;
+    bool wasteful = domain->rows * domain->cols / UNBOUNDED_SHRINK > rows * cols;
+    if (!near && !wasteful) {
+        return false;
+    }
+    if (rows > INT_MAX || cols > LLONG_MAX / rows) {
+        fprintf(stderr, "Error, unbounded window of %lld x %lld cells is too large.\n", rows, cols);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    domain->next_rows = rows;
+    domain->next_cols = cols;
+    domain->shift_row = bounds[0] - pad_rows;
+    domain->shift_col = bounds[1] - pad_cols;
+    return true;
+}
+
+/*
+* @brief Sposta la porzione nella finestra scelta da unbounded_fit e ridistribuisce le righe
+*
+* Ogni processo copia le sue righe che cadono nella nuova finestra, già con la nuova
+* larghezza, in un buffer temporaneo. Arena e buffer di generazione vengono poi riaperti
+* con la nuova divisione delle righe, nello stesso ordine dell'anello, e un'unica
+* MPI_Alltoallv consegna ad ogni processo le righe della sua nuova porzione: le righe
+* e le colonne nuove restano morte.
+* Al termine le righe fantasma della nuova porzione sono già scambiate.
+*
+* @param domain finestra, aggiornata con la nuova posizione e le nuove dimensioni
+* @param halo scambio delle righe di bordo, riaperto sulla nuova porzione
+* @param arena arena del processo, riaperta con la nuova dimensione
+* @param huge_pages alloca l'arena su huge page
+* @param row_data datatype di una riga, ricreato con la nuova larghezza
+* @param rank rank del processo corrente
+* @param num_proc numero di processi
+* @param rows_for_proc righe assegnate ad ogni processo, aggiornate
+* @param displ_for_proc displacement di ogni processo, aggiornati
+* @param slab prima riga posseduta della porzione da spostare
+* @param stats statistiche locali della porzione da spostare, riportate nella nuova finestra, NULL se assenti
+*/
+void unbounded_resize(unbounded_domain *domain, halo_exchange *halo, grid_arena *arena, bool huge_pages, MPI_Datatype *row_data,
+                      int rank, int num_proc, int *rows_for_proc, int *displ_for_proc, char *slab, gen_stats *stats) {
+    const halo_backend *backend = halo->backend;
+    const ring_placement *place = halo->place;
+    long long old_cols = domain->cols, cols = domain->next_cols;
+    long long shift_row = domain->shift_row, shift_col = domain->shift_col;
+    int *old_rows = checked_alloc(num_proc, sizeof(int)), *old_displ = checked_alloc(num_proc, sizeof(int));
+    int *send_counts = checked_alloc(num_proc, sizeof(int)), *send_displ = checked_alloc(num_proc, sizeof(int));
+    int *recv_counts = checked_alloc(num_proc, sizeof(int)), *recv_displ = checked_alloc(num_proc, sizeof(int));
+    memcpy(old_rows, rows_for_proc, num_proc * sizeof(int));
+    memcpy(old_displ, displ_for_proc, num_proc * sizeof(int));
+
+    /* righe possedute che cadono nella nuova finestra, in indici della nuova finestra */
+    long long first = old_displ[rank] - shift_row;
+    long long lo = first > 0 ? first : 0;
+    long long hi = first + old_rows[rank] < domain->next_rows ? first + old_rows[rank] : domain->next_rows;
+    int kept = hi > lo ? (int)(hi - lo) : 0;
+    /* colonne della vecchia finestra che cadono nella nuova */
+    long long col_lo = shift_col > 0 ? shift_col : 0;
+    long long col_hi = shift_col + cols < old_cols ? shift_col + cols : old_cols;
+    char *packed = checked_alloc(kept > 0 ? kept : 1, cols);
+    for (int i = 0; i < kept; i++) {
+        char *row = packed + (size_t)i * cols;
+        memset(row, DEAD, cols);
+        if (col_hi > col_lo) {
+            memcpy(row + (col_lo - shift_col), slab + (size_t)(lo - first + i) * old_cols + col_lo, col_hi - col_lo);
+        }
+    }
+
+    /* la nuova finestra sostituisce la vecchia */
+    long long compact_sent = halo->sent_bytes, compact_messages[2] = { halo->messages[0], halo->messages[1] };
+    halo_close(halo);
+    arena_close(arena);
+    MPI_Type_free(row_data);
+    domain->origin_row += shift_row;
+    domain->origin_col += shift_col;
+    domain->rows = domain->next_rows;
+    domain->cols = cols;
+    if (domain->rows * domain->cols > domain->max_cells) {
+        domain->max_cells = domain->rows * domain->cols;
+    }
+    domain->resizes++;
+    make_row_type(cols, row_data);
+    split_rows(domain->rows, num_proc, place->order, rows_for_proc, displ_for_proc);
+
+    size_t slab_bytes = ((size_t)rows_for_proc[rank] + 2 * domain->radius) * cols;
+    if (!arena_open(arena, 2 * (slab_bytes + ARENA_ALIGN), huge_pages)) {
+        fprintf(stderr, "Error, cannot map %zu bytes on rank %d.\n", 2 * slab_bytes, rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    /* compact rifiuta le finestre troppo larghe per i suoi messaggi, allora si prosegue con ring */
+    if (!halo_open(halo, backend, arena, *row_data, rank, num_proc, place, rows_for_proc, cols, domain->radius)) {
+        if (rank == MASTER) {
+            printf("Warning, halo %s not available for %lld columns: using ring.\n", backend->name, cols);
+        }
+        halo_open(halo, find_halo("ring"), arena, *row_data, rank, num_proc, place, rows_for_proc, cols, domain->radius);
+    }
+    halo->sent_bytes = compact_sent;
+    halo->messages[0] = compact_messages[0];
+    halo->messages[1] = compact_messages[1];
+    char *target = halo->buffers[0];
+    memset(target, DEAD, (size_t)rows_for_proc[rank] * cols);
+
+    /*
+    le divisioni vecchia e nuova seguono lo stesso ordine dell'anello: ogni processo invia
+    al processo q l'intersezione delle sue righe con la nuova porzione di q, e riceve
+    da p l'intersezione delle vecchie righe di p con la sua nuova porzione
+    */
+    for (int q = 0; q < num_proc; q++) {
+        long long start = displ_for_proc[q] > lo ? displ_for_proc[q] : lo;
+        long long end = displ_for_proc[q] + rows_for_proc[q] < hi ? displ_for_proc[q] + rows_for_proc[q] : hi;
+        send_counts[q] = end > start ? (int)(end - start) : 0;
+        send_displ[q] = end > start ? (int)(start - lo) : 0;
+
+        long long p_lo = old_displ[q] - shift_row, p_hi = p_lo + old_rows[q];
+        start = displ_for_proc[rank] > p_lo ? displ_for_proc[rank] : p_lo;
+        end = displ_for_proc[rank] + rows_for_proc[rank] < p_hi ? displ_for_proc[rank] + rows_for_proc[rank] : p_hi;
+        recv_counts[q] = end > start ? (int)(end - start) : 0;
+        recv_displ[q] = end > start ? (int)(start - displ_for_proc[rank]) : 0;
+    }
+    MPI_Alltoallv(packed, send_counts, send_displ, *row_data, target, recv_counts, recv_displ, *row_data, MPI_COMM_WORLD);
+
+    /* le righe fantasma della nuova porzione vengono scambiate subito */
+    backend->start(halo, target);
+    backend->finish(halo);
+
+    /* il bounding box della generazione appena calcolata viene riportato nella nuova finestra */
+    if (stats != NULL && stats->live > 0) {
+        stats->min_row -= shift_row;
+        stats->max_row -= shift_row;
+        stats->min_col -= shift_col;
+        stats->max_col -= shift_col;
+    }
+    free(packed);
+    free(old_rows);
+    free(old_displ);
+    free(send_counts);
+    free(send_displ);
+    free(recv_counts);
+    free(recv_displ);
+}
@@ -0,0 +1,125 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Verifica bit per bit del motore parallelo rispetto al motore sequenziale di riferimento
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "gol_engine.h"
+
+/*
+ * @brief Prepara la verifica: MASTER raccoglie la matrice iniziale nel motore di riferimento
+ * 
+ * Il riferimento parte dalla matrice effettivamente generata dai processi,
+ * quindi la verifica funziona con qualsiasi seed e con i pattern da file.
+ * 
+ * @param check verifica da preparare
+ * @param kernel kernel del motore di riferimento
+ * @param rank rank del processo corrente
+ * @param slab porzione del processo alla generazione iniziale
+ * @param row_size righe della matrice
+ * @param col_size colonne della matrice
+ * @param rows_for_proc righe assegnate ad ogni processo
+ * @param displ_for_proc prima riga di ogni processo
+ * @param row_data datatype che indica una riga della matrice
+ */
+void verify_open(verifier *check, const gol_kernel *kernel, int rank, char *slab, long long row_size, long long col_size,
+                 int *rows_for_proc, int *displ_for_proc, MPI_Datatype row_data) {
+    memset(check, 0, sizeof(verifier));
+    check->kernel = kernel;
+    check->failed_gen = -1;
+    if (rank == MASTER) {
+        reference_open(&check->board, (int)row_size, col_size, kernel_radius(kernel));
+    }
+    MPI_Gatherv(slab, rows_for_proc[rank], row_data, rank == MASTER ? check->board.buffers[0] : NULL,
+                rows_for_proc, displ_for_proc, row_data, MASTER, MPI_COMM_WORLD);
+    if (rank == MASTER) {
+        slab_stats(check->board.buffers[0], (int)row_size, col_size, 0, &check->stats);
+    }
+}
+
+/*
+ * @brief Confronta una generazione del motore parallelo con quella del riferimento
+ * 
+ * MASTER porta il riferimento alla generazione indicata e confronta celle vive e hash
+ * ridotti fra tutti i processi con quelli del riferimento. L'esito viene inviato a tutti,
+ * così i processi terminano insieme. Solo in caso di differenza la porzione di ogni processo
+ * viene raccolta su MASTER per trovare la prima cella diversa.
+ * 
+ * @param check verifica in corso
+ * @param rank rank del processo corrente
+ * @param gen generazione da confrontare, successiva all'ultima confrontata
+ * @param live celle vive della generazione, ridotte fra tutti i processi
+ * @param hash hash della generazione, ridotto fra tutti i processi
+ * @param slab porzione del processo alla generazione indicata
+ * @param rows_for_proc righe assegnate ad ogni processo
+ * @param displ_for_proc prima riga di ogni processo
+ * @param row_data datatype che indica una riga della matrice
+ * @return true se la generazione coincide
+ */
+bool verify_generation(verifier *check, int rank, int gen, unsigned long long live, uint64_t hash, char *slab,
+                       int *rows_for_proc, int *displ_for_proc, MPI_Datatype row_data) {
+    int differs = 0;
+    if (rank == MASTER) {
+        while (check->gen < gen) {
+            reference_step(&check->board, check->kernel, &check->stats);
+            check->gen++;
+        }
+        differs = check->stats.live != (long long)live || check->stats.hash != hash;
+    }
+    MPI_Bcast(&differs, 1, MPI_INT, MASTER, MPI_COMM_WORLD);
+    if (!differs) {
+        check->checked = gen + 1;
+        return true;
+    }
+
+    /* la matrice del motore parallelo viene raccolta una sola volta, alla prima differenza */
+    reference_board *board = &check->board;
+    char *candidate = NULL;
+    if (rank == MASTER) {
+        candidate = checked_alloc(board->rows, board->cols);
+    }
+    MPI_Gatherv(slab, rows_for_proc[rank], row_data, candidate, rows_for_proc, displ_for_proc, row_data, MASTER, MPI_COMM_WORLD);
+    if (rank == MASTER) {
+        const char *expected = board->buffers[board->current];
+        size_t cells = (size_t)board->rows * board->cols;
+        check->failed_cell = -1;
+        for (size_t c = 0; c < cells; c++) {
+            if (expected[c] != candidate[c]) {
+                check->failed_cell = (long long)c;
+                check->expected = expected[c];
+                check->actual = candidate[c];
+                break;
+            }
+        }
+        free(candidate);
+    }
+    check->failed_gen = gen;
+    return false;
+}
+
+/*
+ * @brief Riporta l'esito della verifica e libera il riferimento
+ * 
+ * @param check verifica da chiudere
+ * @param rank rank del processo corrente
+ * @return true se tutte le generazioni confrontate coincidono
+ */
+bool verify_close(verifier *check, int rank) {
+    if (rank == MASTER) {
+        if (check->failed_gen < 0) {
+            printf("Verify: generations 0-%d identical to the sequential reference (kernel %s)\n",
+                   check->checked - 1, check->kernel->name);
+        } else if (check->failed_cell < 0) {
+            /* celle identiche ma hash diverso: non dovrebbe accadere, indica un errore nelle statistiche */
+            printf("Verify: generation %d differs in live count or hash, but all cells match\n", check->failed_gen);
+        } else {
+            printf("Verify: first difference at generation %d, row %lld, column %lld (reference %c, candidate %c)\n",
+                   check->failed_gen, check->failed_cell / check->board.cols, check->failed_cell % check->board.cols,
+                   check->expected, check->actual);
+        }
+        reference_close(&check->board);
+    }
+    return check->failed_gen < 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Game of Life, versione parallela con OpenMPI
+ * Viewport: mappa di densità a bassa risoluzione dell'intera matrice
+ * Francesco Pio Covino
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "gol_engine.h"
+
+/*
+ * @brief Calcola le righe della mappa ridotta toccate da un intervallo di righe globali
+ * 
+ * @param view viewport
+ * @param first_row prima riga globale dell'intervallo
+ * @param rows numero di righe dell'intervallo
+ * @param lo indirizzo in cui memorizzare la prima riga ridotta
+ * @return numero di righe ridotte toccate
+ */
+static int viewport_span(viewport *view, long long first_row, int rows, int *lo) {
+    *lo = (int)(first_row * view->rows / view->row_size);
+    int hi = (int)((first_row + rows - 1) * view->rows / view->row_size);
+    return hi - *lo + 1;
+}
+
+/*
+ * @brief Prepara la viewport: dimensioni della mappa, aree delle celle ridotte e layout della Gatherv
+ * 
+ * @param view viewport da inizializzare
+ * @param opt opzioni da riga di comando
+ * @param rank rank del processo corrente
+ * @param num_proc numero di processi
+ * @param row_size righe della matrice
+ * @param col_size colonne della matrice
+ * @param rows_for_proc righe assegnate ad ogni processo
+ * @param displ_for_proc prima riga di ogni processo
+ * @return true se la viewport è stata preparata
+ */
+bool viewport_open(viewport *view, gol_options *opt, int rank, int num_proc, long long row_size, long long col_size,
+                   int *rows_for_proc, int *displ_for_proc) {
+    memset(view, 0, sizeof(viewport));
+    view->format = opt->viewport_format;
+    view->procs = num_proc;
+    /* la mappa non può essere più fine della matrice */
+    view->rows = opt->viewport_rows < row_size ? opt->viewport_rows : (int)row_size;
+    view->cols = opt->viewport_cols < col_size ? opt->viewport_cols : (int)col_size;
+    view->row_size = row_size;
+    view->col_size = col_size;
+
+    /* ogni colonna della matrice viene associata alla sua colonna ridotta */
+    view->col_map = checked_alloc(col_size, sizeof(int));
+    for (long long j = 0; j < col_size; j++) {
+        view->col_map[j] = (int)(j * view->cols / col_size);
+    }
+    view->local_count = viewport_span(view, displ_for_proc[rank], rows_for_proc[rank], &view->local_lo);
+    view->local = malloc((size_t)view->local_count * view->cols * sizeof(long long));
+
+    if (rank == MASTER) {
+        /* ogni processo invia tutte le righe ridotte che la sua porzione tocca, anche in parte */
+        view->recv_counts = malloc(num_proc * sizeof(int));
+        view->recv_displs = malloc(num_proc * sizeof(int));
+        view->block_lo = malloc(num_proc * sizeof(int));
+        int total = 0;
+        for (int p = 0; p < num_proc; p++) {
+            view->recv_counts[p] = viewport_span(view, displ_for_proc[p], rows_for_proc[p], &view->block_lo[p]) * view->cols;
+            view->recv_displs[p] = total;
+            total += view->recv_counts[p];
+        }
+        view->gathered = malloc(total * sizeof(long long));
+        view->map = malloc((size_t)view->rows * view->cols * sizeof(long long));
+
+        /* celle della matrice coperte da ogni riga e colonna ridotta */
+        view->row_area = calloc(view->rows, sizeof(long long));
+        view->col_area = calloc(view->cols, sizeof(long long));
+        for (long long i = 0; i < row_size; i++) {
+            view->row_area[i * view->rows / row_size]++;
+        }
+        for (long long j = 0; j < col_size; j++) {
+            view->col_area[view->col_map[j]]++;
+        }
+        view->out = opt->viewport_out != NULL ? fopen(opt->viewport_out, "w") : stdout;
+        if (view->out == NULL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * @brief Scrive su file un frame della mappa di densità
+ * 
+ * In formato ANSI il cursore torna in alto a sinistra e la densità viene resa
+ * con caratteri sempre più pieni, in formato PGM ogni frame è un'immagine P5
+ * accodata alle precedenti (leggibile ad esempio da ffmpeg come image2pipe).
+ * 
+ * @param view viewport, solo su MASTER
+ * @param gen generazione mostrata
+ */
+static void viewport_write(viewport *view, int gen) {
+    static const char shades[] = " .:-=+*#%@";
+    FILE *out = view->out;
+    if (view->format == VIEWPORT_PGM) {
+        fprintf(out, "P5\n# generation %d\n%d %d\n255\n", gen, view->cols, view->rows);
+    } else {
+        fprintf(out, "\033[H\033[2JGeneration %d (%dx%d)\n", gen, view->rows, view->cols);
+    }
+    for (int i = 0; i < view->rows; i++) {
+        for (int j = 0; j < view->cols; j++) {
+            double density = (double)view->map[i * view->cols + j] / ((double)view->row_area[i] * view->col_area[j]);
+            if (view->format == VIEWPORT_PGM) {
+                fputc((int)(density * 255.0 + 0.5), out);
+            } else {
+                /* le celle ridotte con almeno una cella viva non sono mai vuote */
+                int shade = (int)(density * (sizeof(shades) - 2) + 0.999);
+                fputc(shades[shade], out);
+            }
+        }
+        if (view->format != VIEWPORT_PGM) {
+            fputc('\n', out);
+        }
+    }
+    fflush(out);
+}
+
+/*
+ * @brief Riduce la porzione del processo a una mappa di densità e la invia a MASTER
+ * 
+ * Ogni processo conta le celle vive per cella ridotta sulle proprie righe,
+ * MPI_Gatherv sposta solo le righe ridotte toccate da ogni processo e MASTER
+ * somma quelle condivise fra processi vicini prima di scrivere il frame.
+ * 
+ * @param view viewport
+ * @param rank rank del processo corrente
+ * @param gen generazione mostrata
+ * @param slab porzione del processo
+ * @param rows numero di righe della porzione
+ * @param first_row indice globale della prima riga della porzione
+ */
+void viewport_frame(viewport *view, int rank, int gen, const char *slab, int rows, long long first_row) {
+    memset(view->local, 0, (size_t)view->local_count * view->cols * sizeof(long long));
+    for (int i = 0; i < rows; i++) {
+        int r = (int)((first_row + i) * view->rows / view->row_size) - view->local_lo;
+        long long *counts = view->local + (size_t)r * view->cols;
+        const char *row = slab + (size_t)i * view->col_size;
+        for (long long j = 0; j < view->col_size; j++) {
+            counts[view->col_map[j]] += row[j] == ALIVE;
+        }
+    }
+    MPI_Gatherv(view->local, view->local_count * view->cols, MPI_LONG_LONG, view->gathered,
+                view->recv_counts, view->recv_displs, MPI_LONG_LONG, MASTER, MPI_COMM_WORLD);
+    if (rank != MASTER) {
+        return;
+    }
+
+    /* i blocchi dei processi vengono sommati nella mappa globale */
+    memset(view->map, 0, (size_t)view->rows * view->cols * sizeof(long long));
+    for (int p = 0; p < view->procs; p++) {
+        long long *block = view->gathered + view->recv_displs[p];
+        long long *target = view->map + (size_t)view->block_lo[p] * view->cols;
+        for (int k = 0; k < view->recv_counts[p]; k++) {
+            target[k] += block[k];
+        }
+    }
+    viewport_write(view, gen);
+}
+
+/*
+ * @brief Libera la viewport
+ * 
+ * @param view viewport da liberare
+ */
+void viewport_close(viewport *view) {
+    if (view->out != NULL && view->out != stdout) {
+        fclose(view->out);
+    }
+    free(view->col_map);
+    free(view->local);
+    free(view->recv_counts);
+    free(view->recv_displs);
+    free(view->block_lo);
+    free(view->gathered);
+    free(view->map);
+    free(view->row_area);
+    free(view->col_area);
+}
@@ -0,0 +1,18 @@
+# Esegue gol con 1 e con 4 processi e confronta le statistiche per generazione,
+# che comprendono l'hash della matrice: devono essere identiche.
+# Parametri: RUN, NP_FLAG, GOL, WORK, ARGS (opzioni separate da spazi)
+separate_arguments(ARGS)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+foreach(procs 1 4)
+    execute_process(COMMAND ${RUN} ${NP_FLAG} ${procs} ${GOL} ${ARGS} --stats=${WORK}/stats_${procs}.txt
+                    RESULT_VARIABLE result OUTPUT_QUIET)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "gol with ${procs} processes failed: ${result}")
+    endif()
+endforeach()
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/stats_1.txt ${WORK}/stats_4.txt
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "stats with 1 and 4 processes differ")
+endif()
@@ -0,0 +1,30 @@
+# Registra una piccola matrice sia in formato delta sia in PBM, ricostruisce alcune
+# generazioni con --seek e le confronta con gli snapshot PBM corrispondenti.
+# Parametri: RUN, NP_FLAG, GOL, WORK
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+set(board --rows=50 --cols=70 --generations=40 --density=0.3 --seed=5 --snapshot=1)
+foreach(format delta pbm)
+    execute_process(COMMAND ${RUN} ${NP_FLAG} 3 ${GOL} ${board} --snapshot-format=${format}
+                            --snapshot-keyframe=8 --snapshot-prefix=${WORK}/${format}
+                    RESULT_VARIABLE result OUTPUT_QUIET)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "recording ${format} snapshots failed: ${result}")
+    endif()
+endforeach()
+# un keyframe, la generazione subito dopo e una a metà fra due keyframe
+foreach(gen 0 8 9 37)
+    string(LENGTH "00000${gen}" length)
+    math(EXPR start "${length} - 6")
+    string(SUBSTRING "00000${gen}" ${start} 6 padded)
+    execute_process(COMMAND ${RUN} ${NP_FLAG} 1 ${GOL} --seek=${gen} --snapshot-prefix=${WORK}/delta
+                    RESULT_VARIABLE result OUTPUT_VARIABLE output)
+    if(NOT result EQUAL 0 OR NOT output MATCHES "rebuilt")
+        message(FATAL_ERROR "seek to generation ${gen} failed: ${output}")
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/delta_${padded}.pbm ${WORK}/pbm_${padded}.pbm
+                    RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "generation ${gen} rebuilt from deltas differs from the PBM snapshot")
+    endif()
+endforeach()